@@ -0,0 +1,84 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <blockencodings.h>
+#include <consensus/amount.h>
+#include <kernel/cs_main.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/setup_common.h>
+#include <test/util/txmempool.h>
+#include <txmempool.h>
+#include <util/check.h>
+
+#include <memory>
+#include <vector>
+
+static void AddTx(const CTransactionRef& tx, const CAmount& fee, CTxMemPool& pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
+{
+    LockPoints lp;
+    AddToMempool(pool, CTxMemPoolEntry(tx, fee, /*time=*/0, /*entry_height=*/1, /*entry_sequence=*/0, /*spends_coinbase=*/false, /*sigops_cost=*/4, lp));
+}
+
+static CTransactionRef MakeTx(FastRandomContext& rng)
+{
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].prevout = COutPoint{Txid::FromUint256(rng.rand256()), 0};
+    tx.vin[0].scriptSig = CScript() << OP_1;
+    tx.vin[0].scriptWitness.stack.push_back({1});
+    tx.vout.resize(1);
+    tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+    tx.vout[0].nValue = 1000;
+    return MakeTransactionRef(tx);
+}
+
+/**
+ * Reconstruct a compact block of 3000 transactions from a 50000 transaction
+ * mempool, with the last 100 block transactions only found in extra_txn.
+ */
+static void BlockEncodingsInitData(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const ChainTestingSetup>(ChainType::MAIN);
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    FastRandomContext rng{/*fDeterministic=*/true};
+
+    constexpr size_t MEMPOOL_SIZE{50000};
+    constexpr size_t BLOCK_SIZE{3000};
+    constexpr size_t EXTRA_SIZE{100};
+
+    CBlock block;
+    block.nBits = 0x207fffff; // a null header is rejected
+    block.vtx.push_back(MakeTx(rng)); // stand-in coinbase, always prefilled
+    std::vector<std::pair<Wtxid, CTransactionRef>> extra_txn;
+    {
+        LOCK2(cs_main, pool.cs);
+        for (size_t i = 0; i < MEMPOOL_SIZE; ++i) {
+            const auto tx{MakeTx(rng)};
+            AddTx(tx, /*fee=*/1000, pool);
+            if (i % (MEMPOOL_SIZE / (BLOCK_SIZE - EXTRA_SIZE)) == 0 && block.vtx.size() < BLOCK_SIZE - EXTRA_SIZE) {
+                block.vtx.push_back(tx);
+            }
+        }
+    }
+    for (size_t i = 0; i < EXTRA_SIZE; ++i) {
+        const auto tx{MakeTx(rng)};
+        extra_txn.emplace_back(tx->GetWitnessHash(), tx);
+        block.vtx.push_back(tx);
+    }
+
+    const CBlockHeaderAndShortTxIDs cmpctblock{block, rng.rand64()};
+
+    bench.run([&] {
+        PartiallyDownloadedBlock pdb{&pool};
+        const auto status{pdb.InitData(cmpctblock, extra_txn)};
+        assert(status == READ_STATUS_OK);
+    });
+}
+
+BENCHMARK(BlockEncodingsInitData, benchmark::PriorityLevel::HIGH);
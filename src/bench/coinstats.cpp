@@ -0,0 +1,57 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <coins.h>
+#include <kernel/coinstats.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+#include <validation.h>
+
+#include <cassert>
+#include <cstdint>
+
+using kernel::CoinStatsHashType;
+using kernel::ComputeUTXOStats;
+
+static void ComputeUTXOStatsBench(benchmark::Bench& bench, CoinStatsHashType hash_type)
+{
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>();
+    Chainstate& chainstate{testing_setup->m_node.chainman->ActiveChainstate()};
+
+    // Fill the coins database with outputs of random txids.
+    FastRandomContext rng{/*fDeterministic=*/true};
+    {
+        LOCK(::cs_main);
+        for (int i = 0; i < 20'000; ++i) {
+            const Txid txid{Txid::FromUint256(rng.rand256())};
+            for (uint32_t n = 0; n < 2; ++n) {
+                chainstate.CoinsTip().AddCoin(COutPoint{txid, n}, Coin{CTxOut{1000, CScript{} << OP_TRUE}, 1, false}, /*possible_overwrite=*/false);
+            }
+        }
+        chainstate.ForceFlushStateToDisk();
+    }
+
+    bench.unit("coinsdb").run([&] {
+        const auto stats{ComputeUTXOStats(hash_type, &chainstate.CoinsDB(), chainstate.m_blockman)};
+        assert(stats && stats->coins_count >= 40'000);
+    });
+}
+
+static void ComputeUTXOStatsMuHash(benchmark::Bench& bench)
+{
+    ComputeUTXOStatsBench(bench, CoinStatsHashType::MUHASH);
+}
+
+static void ComputeUTXOStatsSerialized(benchmark::Bench& bench)
+{
+    ComputeUTXOStatsBench(bench, CoinStatsHashType::HASH_SERIALIZED);
+}
+
+BENCHMARK(ComputeUTXOStatsMuHash, benchmark::PriorityLevel::LOW);
+BENCHMARK(ComputeUTXOStatsSerialized, benchmark::PriorityLevel::LOW);
@@ -86,8 +86,64 @@ static void GCSFilterMatch(benchmark::Bench& bench)
         filter.Match(GCSFilter::Element());
     });
 }
+
+static void GCSFilterMatchAny(benchmark::Bench& bench)
+{
+    auto elements = GenerateGCSTestElements();
+
+    GCSFilter filter({0, 0, BASIC_FILTER_P, BASIC_FILTER_M}, elements);
+
+    // A wallet-sized query set that does not match.
+    GCSFilter::ElementSet query;
+    for (int i = 0; i < 1000; ++i) {
+        GCSFilter::Element element(32);
+        element[2] = static_cast<unsigned char>(i);
+        element[3] = static_cast<unsigned char>(i >> 8);
+        query.insert(std::move(element));
+    }
+
+    bench.run([&] {
+        filter.MatchAny(query);
+    });
+}
+
+static void GCSFilterMatchAnyMany(benchmark::Bench& bench)
+{
+    // 1000 block-sized filters with distinct keys, scanned for a wallet-sized query set,
+    // as in scanblocks.
+    std::vector<GCSFilter> filters;
+    filters.reserve(1000);
+    for (uint64_t k0 = 0; k0 < 1000; ++k0) {
+        GCSFilter::ElementSet elements;
+        for (int i = 0; i < 500; ++i) {
+            GCSFilter::Element element(32);
+            element[0] = static_cast<unsigned char>(i);
+            element[1] = static_cast<unsigned char>(i >> 8);
+            element[4] = static_cast<unsigned char>(k0);
+            element[5] = static_cast<unsigned char>(k0 >> 8);
+            elements.insert(std::move(element));
+        }
+        filters.emplace_back(GCSFilter::Params{k0, 0, BASIC_FILTER_P, BASIC_FILTER_M}, elements);
+    }
+    std::vector<const GCSFilter*> filter_ptrs;
+    for (const GCSFilter& filter : filters) filter_ptrs.push_back(&filter);
+
+    GCSFilter::ElementSet query;
+    for (int i = 0; i < 100; ++i) {
+        GCSFilter::Element element(32);
+        element[2] = static_cast<unsigned char>(i);
+        query.insert(std::move(element));
+    }
+
+    bench.batch(filters.size()).unit("filter").run([&] {
+        GCSFilter::MatchAnyMany(filter_ptrs, query);
+    });
+}
+
 BENCHMARK(GCSBlockFilterGetHash, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterConstruct, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterDecode, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterDecodeSkipCheck, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterMatch, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterMatchAny, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterMatchAnyMany, benchmark::PriorityLevel::HIGH);
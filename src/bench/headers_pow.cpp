@@ -0,0 +1,62 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chainparams.h>
+#include <pow.h>
+#include <primitives/block.h>
+#include <test/util/setup_common.h>
+#include <util/check.h>
+#include <validation.h>
+
+#include <cassert>
+#include <vector>
+
+/** Number of headers in a full headers message */
+static constexpr size_t NUM_HEADERS{2000};
+
+static std::vector<CBlockHeader> CreateHeaders(const CChainParams& params)
+{
+    std::vector<CBlockHeader> headers;
+    headers.reserve(NUM_HEADERS);
+    uint256 prev_hash{params.GenesisBlock().GetHash()};
+    uint32_t time{params.GenesisBlock().nTime};
+    while (headers.size() < NUM_HEADERS) {
+        CBlockHeader& header{headers.emplace_back()};
+        header.nVersion = params.GenesisBlock().nVersion;
+        header.hashPrevBlock = prev_hash;
+        header.nTime = ++time;
+        header.nBits = params.GenesisBlock().nBits;
+        while (!CheckProofOfWork(header.GetHash(), header.nBits, params.GetConsensus())) ++header.nNonce;
+        prev_hash = header.GetHash();
+    }
+    return headers;
+}
+
+static void HeadersPoWCheck(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const ChainTestingSetup>(ChainType::REGTEST)};
+    ChainstateManager& chainman{*Assert(testing_setup->m_node.chainman)};
+    const auto headers{CreateHeaders(chainman.GetParams())};
+
+    bench.batch(headers.size()).unit("header").run([&] {
+        const bool valid{chainman.CheckHeadersProofOfWork(headers)};
+        assert(valid);
+    });
+}
+
+static void HeadersPoWCheckSerial(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<const ChainTestingSetup>(ChainType::REGTEST)};
+    const CChainParams& params{testing_setup->m_node.chainman->GetParams()};
+    const auto headers{CreateHeaders(params)};
+
+    bench.batch(headers.size()).unit("header").run([&] {
+        const bool valid{HasValidProofOfWork(headers, params.GetConsensus())};
+        assert(valid);
+    });
+}
+
+BENCHMARK(HeadersPoWCheck, benchmark::PriorityLevel::HIGH);
+BENCHMARK(HeadersPoWCheckSerial, benchmark::PriorityLevel::HIGH);
@@ -17,8 +17,11 @@
 #include <univalue.h>
 #include <validation.h>
 
+#include <cassert>
 #include <cstddef>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace {
@@ -86,3 +89,20 @@ static void BlockToJsonVerboseWrite(benchmark::Bench& bench)
 }
 
 BENCHMARK(BlockToJsonVerboseWrite, benchmark::PriorityLevel::HIGH);
+
+static void WriteBlockJsonVerbosity3(benchmark::Bench& bench)
+{
+    TestBlockAndIndex data;
+    const uint256 pow_limit{data.testing_setup->m_node.chainman->GetParams().GetConsensus().powLimit};
+    auto& blockman{data.testing_setup->m_node.chainman->m_blockman};
+    std::string streamed;
+    WriteBlockJSON(blockman, data.block, data.blockindex, data.blockindex, TxVerbosity::SHOW_DETAILS_AND_PREVOUT, pow_limit, [&](std::string_view json) { streamed += json; return true; });
+    assert(streamed == blockToJSON(blockman, data.block, data.blockindex, data.blockindex, TxVerbosity::SHOW_DETAILS_AND_PREVOUT, pow_limit).write());
+    bench.run([&] {
+        size_t size{0};
+        WriteBlockJSON(blockman, data.block, data.blockindex, data.blockindex, TxVerbosity::SHOW_DETAILS_AND_PREVOUT, pow_limit, [&](std::string_view json) { size += json.size(); return true; });
+        ankerl::nanobench::doNotOptimizeAway(size);
+    });
+}
+
+BENCHMARK(WriteBlockJsonVerbosity3, benchmark::PriorityLevel::HIGH);
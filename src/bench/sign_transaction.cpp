@@ -7,6 +7,7 @@
 #include <coins.h>
 #include <key.h>
 #include <primitives/transaction.h>
+#include <psbt.h>
 #include <pubkey.h>
 #include <script/interpreter.h>
 #include <script/script.h>
@@ -19,6 +20,7 @@
 
 #include <cassert>
 #include <map>
+#include <utility>
 #include <vector>
 
 enum class InputType {
@@ -73,6 +75,51 @@ static void SignTransactionSingleInput(benchmark::Bench& bench, InputType input_
 static void SignTransactionECDSA(benchmark::Bench& bench)   { SignTransactionSingleInput(bench, InputType::P2WPKH); }
 static void SignTransactionSchnorr(benchmark::Bench& bench) { SignTransactionSingleInput(bench, InputType::P2TR);   }
 
+static void SignPSBTManyInputs(benchmark::Bench& bench, InputType input_type)
+{
+    ECC_Context ecc_context{};
+
+    // A consolidation transaction spending 2000 outputs, each to a different key
+    constexpr uint32_t NUM_INPUTS{2000};
+    FlatSigningProvider keystore;
+    CMutableTransaction unsigned_tx;
+    std::vector<CTxOut> prev_outs;
+    for (uint32_t i = 0; i < NUM_INPUTS; i++) {
+        CKey privkey = GenerateRandomKey();
+        CPubKey pubkey = privkey.GetPubKey();
+        CKeyID key_id = pubkey.GetID();
+        keystore.keys.emplace(key_id, privkey);
+        keystore.pubkeys.emplace(key_id, pubkey);
+
+        CScript prev_spk;
+        switch (input_type) {
+        case InputType::P2WPKH: prev_spk = GetScriptForDestination(WitnessV0KeyHash(pubkey)); break;
+        case InputType::P2TR:   prev_spk = GetScriptForDestination(WitnessV1Taproot(XOnlyPubKey{pubkey})); break;
+        default: assert(false);
+        }
+        prev_outs.emplace_back(10000, prev_spk);
+        unsigned_tx.vin.emplace_back(COutPoint{Txid::FromUint256(uint256::ONE), i});
+    }
+    unsigned_tx.vout.emplace_back(NUM_INPUTS * 9000, prev_outs.front().scriptPubKey);
+    PartiallySignedTransaction unsigned_psbt{unsigned_tx};
+    std::vector<std::pair<unsigned int, const SigningProvider*>> inputs;
+    for (uint32_t i = 0; i < NUM_INPUTS; i++) {
+        unsigned_psbt.inputs[i].witness_utxo = prev_outs[i];
+        inputs.emplace_back(i, &keystore);
+    }
+
+    bench.run([&] {
+        PartiallySignedTransaction psbt{unsigned_psbt};
+        const PrecomputedTransactionData txdata{PrecomputePSBTData(psbt)};
+        for (const PSBTError res : SignPSBTInputs(inputs, psbt, &txdata)) {
+            assert(res == PSBTError::OK);
+        }
+    });
+}
+
+static void SignPSBTManyInputsECDSA(benchmark::Bench& bench)   { SignPSBTManyInputs(bench, InputType::P2WPKH); }
+static void SignPSBTManyInputsSchnorr(benchmark::Bench& bench) { SignPSBTManyInputs(bench, InputType::P2TR);   }
+
 static void SignSchnorrTapTweakBenchmark(benchmark::Bench& bench, bool use_null_merkle_root)
 {
     FastRandomContext rng;
@@ -102,5 +149,7 @@ static void SignSchnorrWithNullMerkleRoot(benchmark::Bench& bench)
 
 BENCHMARK(SignTransactionECDSA, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SignTransactionSchnorr, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SignPSBTManyInputsECDSA, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SignPSBTManyInputsSchnorr, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SignSchnorrWithMerkleRoot, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SignSchnorrWithNullMerkleRoot, benchmark::PriorityLevel::HIGH);
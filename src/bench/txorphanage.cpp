@@ -264,7 +264,41 @@ static void OrphanageEraseForPeer(benchmark::Bench& bench)
     OrphanageEraseAll(bench, /*block_or_disconnect=*/false);
 }
 
+static void OrphanageAddChildrenToWorkSet(benchmark::Bench& bench)
+{
+    FastRandomContext det_rand{true};
+    const auto orphanage{node::MakeTxOrphanage(/*max_global_ann=*/node::DEFAULT_MAX_ORPHANAGE_LATENCY_SCORE, /*reserved_peer_usage=*/node::DEFAULT_RESERVED_ORPHAN_WEIGHT_PER_PEER)};
+    constexpr unsigned int NUM_PEERS{125};
+    constexpr unsigned int NUM_TXNS_PER_PEER = node::DEFAULT_MAX_ORPHANAGE_LATENCY_SCORE / NUM_PEERS;
+    constexpr unsigned int NUM_CHILDREN{NUM_PEERS * NUM_TXNS_PER_PEER};
+
+    // A single parent whose every output is spent by a different orphan, each announced by a different peer than
+    // its neighbours. Accepting the parent has to walk all of its outputs and touch every peer's work set.
+    CMutableTransaction parent;
+    parent.vin.emplace_back(Txid::FromUint256(det_rand.rand256()), 0);
+    parent.vout.resize(NUM_CHILDREN);
+    const auto parent_tx{MakeTransactionRef(parent)};
+
+    for (unsigned int i{0}; i < NUM_CHILDREN; ++i) {
+        CMutableTransaction child;
+        child.vin.emplace_back(parent_tx->GetHash(), i);
+        child.vout.resize(1);
+        assert(orphanage->AddTx(MakeTransactionRef(child), /*peer=*/i % NUM_PEERS));
+    }
+    assert(orphanage->CountAnnouncements() == NUM_CHILDREN);
+    assert(orphanage->TotalLatencyScore() <= orphanage->MaxGlobalLatencyScore());
+    assert(orphanage->TotalOrphanUsage() <= orphanage->MaxGlobalUsage());
+
+    // AddChildrenToWorkSet marks every child for reconsideration, so later calls would find nothing
+    // left to add. Measure the first call only.
+    bench.epochs(1).epochIterations(1).run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        const auto children{orphanage->AddChildrenToWorkSet(*parent_tx, det_rand)};
+        assert(children.size() == NUM_CHILDREN);
+    });
+}
+
 BENCHMARK(OrphanageSinglePeerEviction, benchmark::PriorityLevel::LOW);
 BENCHMARK(OrphanageMultiPeerEviction, benchmark::PriorityLevel::LOW);
 BENCHMARK(OrphanageEraseForBlock, benchmark::PriorityLevel::LOW);
 BENCHMARK(OrphanageEraseForPeer, benchmark::PriorityLevel::LOW);
+BENCHMARK(OrphanageAddChildrenToWorkSet, benchmark::PriorityLevel::LOW);
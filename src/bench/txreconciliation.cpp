@@ -0,0 +1,113 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <netmessagemaker.h>
+#include <node/txreconciliation.h>
+#include <protocol.h>
+#include <random.h>
+#include <util/transaction_identifier.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+/** Number of transactions both sides of a connection have. */
+static constexpr size_t NUM_COMMON{1000};
+/** Number of transactions only one side has. */
+static constexpr size_t NUM_DIFF{20};
+
+/** Bytes a v1 transport message takes on the wire. */
+static size_t WireSize(const CSerializedNetMsg& msg)
+{
+    return CMessageHeader::HEADER_SIZE + msg.data.size();
+}
+
+static size_t InvWireSize(const std::vector<Wtxid>& wtxids)
+{
+    if (wtxids.empty()) return 0;
+    std::vector<CInv> invs;
+    invs.reserve(wtxids.size());
+    for (const Wtxid& wtxid : wtxids) {
+        invs.emplace_back(MSG_WTX, wtxid.ToUint256());
+    }
+    return WireSize(NetMsg::Make(NetMsgType::INV, invs));
+}
+
+/**
+ * Transaction announcements over one connection where both sides already learned
+ * NUM_COMMON transactions from other peers, and NUM_DIFF are only known to one side.
+ * With flooding, each of them is announced once over the connection, whichever side
+ * sends it.
+ */
+static void TxFloodingRound(benchmark::Bench& bench)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<Wtxid> initiator_invs, responder_invs;
+    for (size_t i = 0; i < NUM_COMMON + NUM_DIFF; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(rng.rand256())};
+        (i % 2 == 0 ? initiator_invs : responder_invs).push_back(wtxid);
+    }
+
+    const auto round = [&] {
+        return InvWireSize(initiator_invs) + InvWireSize(responder_invs);
+    };
+
+    bench.batch(NUM_COMMON + NUM_DIFF).unit("tx").run([&] {
+        ankerl::nanobench::doNotOptimizeAway(round());
+    });
+}
+
+/**
+ * The same announcements as TxFloodingRound with one full BIP-330 reconciliation round:
+ * reqrecon, sketch, reconcildiff, and inv messages for the set difference in both
+ * directions. The round must take fewer wire bytes than flooding the same transactions.
+ */
+static void TxReconciliationRound(benchmark::Bench& bench)
+{
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    const NodeId peer_id{0};
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(peer_id)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(peer_id)};
+    initiator.RegisterPeer(peer_id, /*is_peer_inbound=*/false, TXRECONCILIATION_VERSION, responder_salt);
+    responder.RegisterPeer(peer_id, /*is_peer_inbound=*/true, TXRECONCILIATION_VERSION, initiator_salt);
+
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<Wtxid> initiator_set, responder_set, all_wtxids;
+    for (size_t i = 0; i < NUM_COMMON + NUM_DIFF; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(rng.rand256())};
+        if (i < NUM_COMMON || i % 2 == 0) initiator_set.push_back(wtxid);
+        if (i < NUM_COMMON || i % 2 == 1) responder_set.push_back(wtxid);
+        all_wtxids.push_back(wtxid);
+    }
+
+    const auto round = [&] {
+        for (const Wtxid& wtxid : initiator_set) initiator.AddToSet(peer_id, wtxid);
+        for (const Wtxid& wtxid : responder_set) responder.AddToSet(peer_id, wtxid);
+
+        const auto request{initiator.InitiateReconciliationRequest(peer_id)};
+        assert(request);
+        size_t wire_bytes{WireSize(NetMsg::Make(NetMsgType::REQRECON, request->first, request->second))};
+        const auto sketch{responder.HandleReconciliationRequest(peer_id, request->first, request->second)};
+        assert(sketch);
+        wire_bytes += WireSize(NetMsg::Make(NetMsgType::SKETCH, *sketch));
+        const auto result{initiator.ReconcileWithSketch(peer_id, *sketch)};
+        assert(result && result->success);
+        wire_bytes += WireSize(NetMsg::Make(NetMsgType::RECONCILDIFF, result->success, result->request));
+        wire_bytes += InvWireSize(result->announce);
+        const auto announce{responder.HandleReconciliationDifference(peer_id, result->success, result->request)};
+        assert(announce && announce->size() == NUM_DIFF / 2);
+        wire_bytes += InvWireSize(*announce);
+        return wire_bytes;
+    };
+
+    assert(round() < InvWireSize(all_wtxids));
+    bench.batch(NUM_COMMON + NUM_DIFF).unit("tx").run([&] {
+        ankerl::nanobench::doNotOptimizeAway(round());
+    });
+}
+
+BENCHMARK(TxFloodingRound, benchmark::PriorityLevel::HIGH);
+BENCHMARK(TxReconciliationRound, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,54 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <random.h>
+#include <txrequest.h>
+#include <uint256.h>
+#include <util/transaction_identifier.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/** Number of peers announcing every transaction. */
+static constexpr int NUM_PEERS{125};
+/** Number of new transactions announced per round. */
+static constexpr size_t TXS_PER_ROUND{40};
+
+/**
+ * A transaction flood: every round, all peers announce the same new
+ * transactions (NUM_PEERS * TXS_PER_ROUND = 5000 announcements), each
+ * transaction is requested from the best peer, and forgotten once received.
+ */
+static void TxRequestFlood(benchmark::Bench& bench)
+{
+    TxRequestTracker tracker{/*deterministic=*/true};
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::chrono::microseconds now{1'000'000};
+
+    bench.batch(NUM_PEERS * TXS_PER_ROUND).unit("announcement").run([&] {
+        std::vector<GenTxid> gtxids;
+        gtxids.reserve(TXS_PER_ROUND);
+        for (size_t i = 0; i < TXS_PER_ROUND; ++i) {
+            gtxids.emplace_back(Wtxid::FromUint256(rng.rand256()));
+        }
+        for (NodeId peer = 0; peer < NUM_PEERS; ++peer) {
+            for (const GenTxid& gtxid : gtxids) {
+                tracker.ReceivedInv(peer, gtxid, /*preferred=*/peer % 8 == 0, now);
+            }
+        }
+        now += std::chrono::milliseconds{10};
+        for (NodeId peer = 0; peer < NUM_PEERS; ++peer) {
+            for (const GenTxid& gtxid : tracker.GetRequestable(peer, now)) {
+                tracker.RequestedTx(peer, gtxid.ToUint256(), now + std::chrono::seconds{60});
+            }
+        }
+        for (const GenTxid& gtxid : gtxids) {
+            tracker.ForgetTxHash(gtxid.ToUint256());
+        }
+    });
+}
+
+BENCHMARK(TxRequestFlood, benchmark::PriorityLevel::HIGH);
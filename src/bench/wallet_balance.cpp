@@ -2,11 +2,14 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <addresstype.h>
 #include <bench/bench.h>
 #include <interfaces/chain.h>
 #include <kernel/chainparams.h>
+#include <key_io.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <script/script.h>
 #include <sync.h>
 #include <test/util/mining.h>
 #include <test/util/setup_common.h>
@@ -64,8 +67,39 @@ static void WalletBalanceClean(benchmark::Bench& bench) { WalletBalance(bench, /
 static void WalletBalanceMine(benchmark::Bench& bench) { WalletBalance(bench, /*set_dirty=*/false, /*add_mine=*/true); }
 static void WalletBalanceWatch(benchmark::Bench& bench) { WalletBalance(bench, /*set_dirty=*/false, /*add_mine=*/false); }
 
+static void WalletBalanceHistory(benchmark::Bench& bench)
+{
+    const auto test_setup = MakeNoLogFileContext<const TestingSetup>();
+
+    SetMockTime(test_setup->m_node.chainman->GetParams().GenesisBlock().nTime);
+    CWallet wallet{test_setup->m_node.chain.get(), "", CreateMockableWalletDatabase()};
+    {
+        LOCK(wallet.cs_wallet);
+        wallet.SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+        wallet.SetupDescriptorScriptPubKeyMans();
+    }
+    auto handler = test_setup->m_node.chain->handleNotifications({&wallet, [](CWallet*) {}});
+
+    const std::string address_mine{getnewaddress(wallet)};
+    for (int i = 0; i < 110; ++i) {
+        generatetoaddress(test_setup->m_node, address_mine);
+    }
+    wallet.chain().waitForNotificationsIfTipChanged(uint256::ZERO);
+
+    // A long history of spent outputs, as accumulated by a busy wallet
+    AddSpentHistory(wallet, GetScriptForDestination(DecodeDestination(address_mine)), /*num_txs=*/100'000);
+
+    auto bal = GetBalance(wallet); // Cache
+
+    bench.run([&] {
+        bal = GetBalance(wallet);
+        assert(bal.m_mine_trusted > 0);
+    });
+}
+
 BENCHMARK(WalletBalanceDirty, benchmark::PriorityLevel::HIGH);
 BENCHMARK(WalletBalanceClean, benchmark::PriorityLevel::HIGH);
 BENCHMARK(WalletBalanceMine, benchmark::PriorityLevel::HIGH);
 BENCHMARK(WalletBalanceWatch, benchmark::PriorityLevel::HIGH);
+BENCHMARK(WalletBalanceHistory, benchmark::PriorityLevel::LOW);
 } // namespace wallet
@@ -3,14 +3,21 @@
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <key.h>
+#include <key_io.h>
+#include <outputtype.h>
 #include <random.h>
+#include <script/descriptor.h>
+#include <script/signingprovider.h>
 #include <support/allocators/secure.h>
+#include <sync.h>
 #include <test/util/setup_common.h>
 #include <uint256.h>
 #include <util/fs.h>
 #include <util/translation.h>
 #include <wallet/context.h>
 #include <wallet/db.h>
+#include <wallet/test/util.h>
 #include <wallet/wallet.h>
 #include <wallet/walletutil.h>
 
@@ -57,10 +64,83 @@ static void WalletCreate(benchmark::Bench& bench, bool encrypted)
     });
 }
 
+static void WalletTopUpMultisig(benchmark::Bench& bench)
+{
+    const auto test_setup = MakeNoLogFileContext<TestingSetup>();
+
+    WalletContext context;
+    context.args = &test_setup->m_args;
+    context.chain = test_setup->m_node.chain.get();
+
+    auto wallet = TestLoadWallet(CreateMockableWalletDatabase(), context, WALLET_FLAG_DESCRIPTORS | WALLET_FLAG_BLANK_WALLET);
+
+    bench.run([&] {
+        // Import a 2-of-3 multisig descriptor with new keys, which tops up DEFAULT_KEYPOOL_SIZE indexes
+        std::string desc_str{"wsh(multi(2"};
+        for (int i = 0; i < 3; ++i) {
+            CExtKey xprv;
+            xprv.SetSeed(GenerateRandomKey());
+            desc_str += "," + EncodeExtKey(xprv) + "/0/*";
+        }
+        desc_str += "))";
+        FlatSigningProvider keys;
+        std::string error;
+        std::vector<std::unique_ptr<Descriptor>> desc = Parse(desc_str, keys, error, /*require_checksum=*/false);
+        WalletDescriptor w_desc(std::move(desc.at(0)), /*creation_time=*/0, /*range_start=*/0, /*range_end=*/0, /*next_index=*/0);
+        LOCK(wallet->cs_wallet);
+        assert(wallet->AddWalletDescriptor(w_desc, keys, /*label=*/"", /*internal=*/false));
+    });
+
+    TestUnloadWallet(std::move(wallet));
+}
+
+static void WalletGetNewDestinations(benchmark::Bench& bench, size_t batch_size)
+{
+    auto test_setup = MakeNoLogFileContext<TestingSetup>();
+
+    WalletContext context;
+    context.args = &test_setup->m_args;
+    context.chain = test_setup->m_node.chain.get();
+
+    DatabaseOptions options;
+    options.require_format = DatabaseFormat::SQLITE;
+    options.require_create = true;
+    options.create_flags = WALLET_FLAG_DESCRIPTORS;
+
+    DatabaseStatus status;
+    bilingual_str error_string;
+    std::vector<bilingual_str> warnings;
+
+    auto wallet_path = fs::PathToString(test_setup->m_path_root / "test_wallet");
+    auto wallet = CreateWallet(context, wallet_path, /*load_on_start=*/std::nullopt, options, status, error_string, warnings);
+    assert(status == DatabaseStatus::SUCCESS);
+    assert(wallet != nullptr);
+
+    // Report the time per address, whether they are requested one at a time or in batches
+    bench.batch(batch_size).unit("address").run([&] {
+        if (batch_size == 1) {
+            auto dest = wallet->GetNewDestination(OutputType::BECH32, /*label=*/"");
+            assert(dest);
+        } else {
+            auto dests = wallet->GetNewDestinations(OutputType::BECH32, /*label=*/"", batch_size);
+            assert(dests && dests->size() == batch_size);
+        }
+    });
+
+    RemoveWallet(context, wallet, /*load_on_start=*/std::nullopt);
+    WaitForDeleteWallet(std::move(wallet));
+    fs::remove_all(wallet_path);
+}
+
 static void WalletCreatePlain(benchmark::Bench& bench) { WalletCreate(bench, /*encrypted=*/false); }
 static void WalletCreateEncrypted(benchmark::Bench& bench) { WalletCreate(bench, /*encrypted=*/true); }
+static void WalletGetNewDestination(benchmark::Bench& bench) { WalletGetNewDestinations(bench, /*batch_size=*/1); }
+static void WalletGetNewDestinationsBatch(benchmark::Bench& bench) { WalletGetNewDestinations(bench, /*batch_size=*/1000); }
 
 BENCHMARK(WalletCreatePlain, benchmark::PriorityLevel::LOW);
 BENCHMARK(WalletCreateEncrypted, benchmark::PriorityLevel::LOW);
+BENCHMARK(WalletTopUpMultisig, benchmark::PriorityLevel::LOW);
+BENCHMARK(WalletGetNewDestination, benchmark::PriorityLevel::LOW);
+BENCHMARK(WalletGetNewDestinationsBatch, benchmark::PriorityLevel::LOW);
 
 } // namespace wallet
@@ -39,6 +39,7 @@
 #include <utility>
 #include <vector>
 
+using wallet::AddSpentHistory;
 using wallet::CWallet;
 using wallet::CreateMockableWalletDatabase;
 using wallet::WALLET_FLAG_DESCRIPTORS;
@@ -166,7 +167,7 @@ static void WalletCreateTx(benchmark::Bench& bench, const OutputType output_type
     });
 }
 
-static void AvailableCoins(benchmark::Bench& bench, const std::vector<OutputType>& output_type)
+static void AvailableCoins(benchmark::Bench& bench, const std::vector<OutputType>& output_type, int history_size = 0)
 {
     const auto test_setup = MakeNoLogFileContext<const TestingSetup>();
     // Set clock to genesis block, so the descriptors/keys creation time don't interfere with the blocks scanning process.
@@ -194,14 +195,18 @@ static void AvailableCoins(benchmark::Bench& bench, const std::vector<OutputType
         }
     }
 
+    // A long history of spent outputs, leaving a single 1 BTC output unspent
+    if (history_size > 0) AddSpentHistory(wallet, dest_wallet.front(), history_size);
+    const int history_utxos{history_size > 0 ? 1 : 0};
+
     // Check available balance
     auto bal = WITH_LOCK(wallet.cs_wallet, return wallet::AvailableCoins(wallet).GetTotalAmount()); // Cache
-    assert(bal == 49 * COIN * (chain_size - COINBASE_MATURITY));
+    assert(bal == 49 * COIN * (chain_size - COINBASE_MATURITY) + history_utxos * COIN);
 
     bench.run([&] {
         LOCK(wallet.cs_wallet);
         const auto& res = wallet::AvailableCoins(wallet);
-        assert(res.All().size() == (chain_size - COINBASE_MATURITY) * 2);
+        assert(res.All().size() == (chain_size - COINBASE_MATURITY) * 2 + history_utxos);
     });
 }
 
@@ -212,7 +217,9 @@ static void WalletCreateTxUsePresetInputsAndCoinSelection(benchmark::Bench& benc
                                                                                                     {{/*num_of_internal_inputs=*/4}}); }
 
 static void WalletAvailableCoins(benchmark::Bench& bench) { AvailableCoins(bench, {OutputType::BECH32M}); }
+static void WalletAvailableCoinsHistory(benchmark::Bench& bench) { AvailableCoins(bench, {OutputType::BECH32M}, /*history_size=*/100'000); }
 
 BENCHMARK(WalletCreateTxUseOnlyPresetInputs, benchmark::PriorityLevel::LOW)
 BENCHMARK(WalletCreateTxUsePresetInputsAndCoinSelection, benchmark::PriorityLevel::LOW)
 BENCHMARK(WalletAvailableCoins, benchmark::PriorityLevel::LOW);
+BENCHMARK(WalletAvailableCoinsHistory, benchmark::PriorityLevel::LOW);
@@ -25,9 +25,10 @@
 #include <utility>
 
 namespace wallet {
-static void WalletIsMine(benchmark::Bench& bench, int num_combo = 0)
+static void WalletIsMine(benchmark::Bench& bench, int num_combo = 0, int keypool_size = 0)
 {
     const auto test_setup = MakeNoLogFileContext<TestingSetup>();
+    if (keypool_size > 0) test_setup->m_args.ForceSetArg("-keypool", std::to_string(keypool_size));
 
     WalletContext context;
     context.args = &test_setup->m_args;
@@ -67,6 +68,9 @@ static void WalletIsMine(benchmark::Bench& bench, int num_combo = 0)
 
 static void WalletIsMineDescriptors(benchmark::Bench& bench) { WalletIsMine(bench); }
 static void WalletIsMineMigratedDescriptors(benchmark::Bench& bench) { WalletIsMine(bench, /*num_combo=*/2000); }
+// 8 active descriptors with 12500 keys each, i.e. 100000 cached scriptPubKeys
+static void WalletIsMineLargeKeypool(benchmark::Bench& bench) { WalletIsMine(bench, /*num_combo=*/0, /*keypool_size=*/12500); }
 BENCHMARK(WalletIsMineDescriptors, benchmark::PriorityLevel::LOW);
 BENCHMARK(WalletIsMineMigratedDescriptors, benchmark::PriorityLevel::LOW);
+BENCHMARK(WalletIsMineLargeKeypool, benchmark::PriorityLevel::LOW);
 } // namespace wallet
@@ -30,14 +30,23 @@ uint64_t GCSFilter::HashToRange(const Element& element) const
     return FastRange64(hash, m_F);
 }
 
+/** Hash each element to the range [0, F) and sort the results into hashed_elements. The keyed
+ *  hasher state is computed once and copied for every element. */
+template <typename Elements>
+static void HashToSortedRange(const CSipHasher& hasher, uint64_t F, const Elements& elements, std::vector<uint64_t>& hashed_elements)
+{
+    hashed_elements.clear();
+    for (const auto& element : elements) {
+        hashed_elements.push_back(FastRange64(CSipHasher{hasher}.Write(element).Finalize(), F));
+    }
+    std::sort(hashed_elements.begin(), hashed_elements.end());
+}
+
 std::vector<uint64_t> GCSFilter::BuildHashedSet(const ElementSet& elements) const
 {
     std::vector<uint64_t> hashed_elements;
     hashed_elements.reserve(elements.size());
-    for (const Element& element : elements) {
-        hashed_elements.push_back(HashToRange(element));
-    }
-    std::sort(hashed_elements.begin(), hashed_elements.end());
+    HashToSortedRange(CSipHasher(m_params.m_siphash_k0, m_params.m_siphash_k1), m_F, elements, hashed_elements);
     return hashed_elements;
 }
 
@@ -144,6 +153,26 @@ bool GCSFilter::MatchAny(const ElementSet& elements) const
     return MatchInternal(queries.data(), queries.size());
 }
 
+std::vector<bool> GCSFilter::MatchAnyMany(std::span<const GCSFilter* const> filters, const ElementSet& elements)
+{
+    // Walking a contiguous vector is cheaper than walking the hash set's nodes once per filter.
+    const std::vector<std::span<const unsigned char>> flat_elements(elements.begin(), elements.end());
+    std::vector<uint64_t> queries;
+    queries.reserve(flat_elements.size());
+
+    std::vector<bool> ret;
+    ret.reserve(filters.size());
+    for (const GCSFilter* filter : filters) {
+        if (filter->m_N == 0 || flat_elements.empty()) {
+            ret.push_back(false);
+            continue;
+        }
+        HashToSortedRange(CSipHasher(filter->m_params.m_siphash_k0, filter->m_params.m_siphash_k1), filter->m_F, flat_elements, queries);
+        ret.push_back(filter->MatchInternal(queries.data(), queries.size()));
+    }
+    return ret;
+}
+
 const std::string& BlockFilterTypeName(BlockFilterType filter_type)
 {
     static std::string unknown_retval;
@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <ios>
 #include <set>
+#include <span>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -84,6 +85,14 @@ public:
      * efficient that checking Match on multiple elements separately.
      */
     bool MatchAny(const ElementSet& elements) const;
+
+    /**
+     * Checks the same elements against several filters: the result holds
+     * filters[i]->MatchAny(elements) at index i. This is more efficient than
+     * calling MatchAny on each filter, as the element set is walked once and
+     * the buffer of hashed elements is shared by all filters.
+     */
+    static std::vector<bool> MatchAnyMany(std::span<const GCSFilter* const> filters, const ElementSet& elements);
 };
 
 constexpr uint8_t BASIC_FILTER_P = 19;
@@ -11,13 +11,18 @@
 #include <netaddress.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
+#include <sync.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
 #include <util/strencodings.h>
 #include <util/string.h>
+#include <util/threadpool.h>
 #include <walletinitinterface.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <iterator>
 #include <map>
 #include <memory>
@@ -38,6 +43,107 @@ static std::vector<std::vector<std::string>> g_rpcauth;
 static std::map<std::string, std::set<std::string>> g_rpc_whitelist;
 static bool g_rpc_whitelist_default = false;
 
+/**
+ * Methods that only read chain data. Consecutive calls to them within a batch
+ * request are run concurrently when -rpcbatchthreads is set.
+ */
+static const std::set<std::string, std::less<>> PARALLEL_BATCH_METHODS{
+    "getaddresshistory",
+    "getbestblockhash",
+    "getblock",
+    "getblockcount",
+    "getblockfilter",
+    "getblockhash",
+    "getblockheader",
+    "getblockstats",
+    "getrawtransaction",
+    "gettxout",
+    "gettxoutproof",
+};
+
+/** Execute a request of a batch. Batches never throw HTTP errors, they are
+ * always just included in "HTTP OK" responses. */
+static UniValue ExecBatchRequest(JSONRPCRequest& jreq, const UniValue& request)
+{
+    try {
+        jreq.parse(request);
+        return JSONRPCExec(jreq, /*catch_errors=*/true);
+    } catch (UniValue& e) {
+        return JSONRPCReplyObj(NullUniValue, std::move(e), jreq.id, jreq.m_json_version);
+    } catch (const std::exception& e) {
+        return JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id, jreq.m_json_version);
+    }
+}
+
+/** A request of a batch, executed concurrently with the others of its run. Never fails: errors are part of the response. */
+class ParallelBatchRequest
+{
+    JSONRPCRequest m_jreq;
+    const UniValue* m_request;
+    std::optional<UniValue>* m_response;
+
+public:
+    ParallelBatchRequest(JSONRPCRequest jreq, const UniValue& request, std::optional<UniValue>& response)
+        : m_jreq{std::move(jreq)}, m_request{&request}, m_response{&response} {}
+
+    void operator()()
+    {
+        UniValue response{ExecBatchRequest(m_jreq, *m_request)};
+        // Notifications never get any response.
+        if (!m_jreq.IsNotification()) *m_response = std::move(response);
+    }
+};
+
+/** A run of batch requests, shared between the HTTP worker executing it and the pool threads helping it. */
+struct ParallelBatchRun
+{
+    std::vector<ParallelBatchRequest>& requests;
+    std::atomic<size_t> next{0};
+    Mutex mutex;
+    std::condition_variable cond GUARDED_BY(mutex);
+    //! Pool threads currently executing requests of this run
+    int active GUARDED_BY(mutex){0};
+    //! Set once every request has been taken, after which pool threads must not join the run
+    bool closed GUARDED_BY(mutex){false};
+
+    explicit ParallelBatchRun(std::vector<ParallelBatchRequest>& r) : requests{r} {}
+
+    void Exec()
+    {
+        for (size_t i; (i = next++) < requests.size();) {
+            requests[i]();
+        }
+    }
+};
+
+/**
+ * Execute a run of batch requests on the calling thread, helped by the pool
+ * threads that are free. The calling thread never waits for a pool thread to
+ * become available, only for the requests already being executed by one.
+ */
+static void ExecParallelBatchRequests(std::vector<ParallelBatchRequest>& requests, util::ThreadPool& pool)
+{
+    const auto run{std::make_shared<ParallelBatchRun>(requests)};
+    const int num_helpers{std::min(int(requests.size()) - 1, pool.Size())};
+    for (int i = 0; i < num_helpers; ++i) {
+        pool.Submit([run] {
+            {
+                LOCK(run->mutex);
+                if (run->closed) return;
+                ++run->active;
+            }
+            run->Exec();
+            LOCK(run->mutex);
+            --run->active;
+            run->cond.notify_all();
+        });
+    }
+    run->Exec();
+    WAIT_LOCK(run->mutex, lock);
+    run->closed = true;
+    while (run->active > 0) run->cond.wait(lock);
+}
+
 static void JSONErrorReply(HTTPRequest* req, UniValue objError, const JSONRPCRequest& jreq)
 {
     // Sending HTTP errors is a legacy JSON-RPC behavior.
@@ -55,7 +161,7 @@ static void JSONErrorReply(HTTPRequest* req, UniValue objError, const JSONRPCReq
     std::string strReply = JSONRPCReplyObj(NullUniValue, std::move(objError), jreq.id, jreq.m_json_version).write() + "\n";
 
     req->WriteHeader("Content-Type", "application/json");
-    req->WriteReply(nStatus, strReply);
+    req->WriteReply(nStatus, std::move(strReply));
 }
 
 //This function checks username and password against -rpcauth
@@ -101,7 +207,7 @@ static bool RPCAuthorized(const std::string& strAuth, std::string& strAuthUserna
     return CheckUserAuthorized(user, pass);
 }
 
-static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
+static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req, util::ThreadPool* batch_pool)
 {
     // JSONRPC handles only POST
     if (req->GetRequestMethod() != HTTPRequest::POST) {
@@ -190,23 +296,36 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
                 }
             }
 
-            // Execute each request
-            reply = UniValue::VARR;
+            // Execute each request. Runs of consecutive read-only requests are
+            // executed concurrently if -rpcbatchthreads is set; any other
+            // request waits for the ones before it, and the responses are
+            // returned in order.
+            std::vector<std::optional<UniValue>> responses(valRequest.size());
+            std::vector<ParallelBatchRequest> run;
+            const auto complete_run{[&] {
+                if (run.empty()) return;
+                ExecParallelBatchRequests(run, *batch_pool);
+                run.clear();
+            }};
             for (size_t i{0}; i < valRequest.size(); ++i) {
-                // Batches never throw HTTP errors, they are always just included
-                // in "HTTP OK" responses. Notifications never get any response.
-                UniValue response;
-                try {
-                    jreq.parse(valRequest[i]);
-                    response = JSONRPCExec(jreq, /*catch_errors=*/true);
-                } catch (UniValue& e) {
-                    response = JSONRPCReplyObj(NullUniValue, std::move(e), jreq.id, jreq.m_json_version);
-                } catch (const std::exception& e) {
-                    response = JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id, jreq.m_json_version);
-                }
-                if (!jreq.IsNotification()) {
-                    reply.push_back(std::move(response));
+                const UniValue& request{valRequest[i]};
+                if (batch_pool && request.isObject()) {
+                    const UniValue& method{request.find_value("method")};
+                    if (method.isStr() && PARALLEL_BATCH_METHODS.contains(method.get_str())) {
+                        run.emplace_back(jreq, request, responses[i]);
+                        continue;
+                    }
                 }
+                complete_run();
+                UniValue response{ExecBatchRequest(jreq, request)};
+                // Notifications never get any response.
+                if (!jreq.IsNotification()) responses[i] = std::move(response);
+            }
+            complete_run();
+
+            reply = UniValue::VARR;
+            for (auto& response : responses) {
+                if (response) reply.push_back(std::move(*response));
             }
             // Return no response for an all-notification batch, but only if the
             // batch request is non-empty. Technically according to the JSON-RPC
@@ -334,7 +453,10 @@ bool StartHTTPRPC(const std::any& context)
     if (!InitRPCAuthentication())
         return false;
 
-    auto handle_rpc = [context](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req); };
+    // The handlers own the batch thread pool, so it is stopped once the requests still being handled are done with it.
+    const int batch_threads{int(std::clamp<int64_t>(gArgs.GetIntArg("-rpcbatchthreads", DEFAULT_RPC_BATCH_THREADS), 0, MAX_RPC_BATCH_THREADS))};
+    std::shared_ptr<util::ThreadPool> batch_pool{batch_threads > 0 ? std::make_shared<util::ThreadPool>(batch_threads, "rpcbatch") : nullptr};
+    auto handle_rpc = [context, batch_pool](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req, batch_pool.get()); };
     RegisterHTTPHandler("/", true, handle_rpc);
     if (g_wallet_init_interface.HasWalletSupport()) {
         RegisterHTTPHandler("/wallet/", false, handle_rpc);
@@ -7,6 +7,15 @@
 
 #include <any>
 
+/**
+ * The default value for `-rpcbatchthreads`. If non-zero, this many threads,
+ * shared by all JSON-RPC batch requests, help the HTTP workers execute the
+ * read-only calls of batches.
+ */
+static const int DEFAULT_RPC_BATCH_THREADS{0};
+//! Maximum value for `-rpcbatchthreads`
+static const int MAX_RPC_BATCH_THREADS{64};
+
 /** Start HTTP RPC subsystem.
  * Precondition; HTTP and RPC has been started.
  */
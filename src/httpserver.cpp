@@ -19,6 +19,7 @@
 #include <util/threadnames.h>
 #include <util/translation.h>
 
+#include <chrono>
 #include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
@@ -49,6 +50,9 @@ using common::InvalidPortErrMsg;
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
 
+/** Maximum number of bytes of a chunked reply waiting to be written to the socket before the writer blocks */
+static const size_t MAX_CHUNKED_REPLY_PENDING = 1 << 20;
+
 /** HTTP request work item */
 class HTTPWorkItem final : public HTTPClosure
 {
@@ -153,6 +157,16 @@ static std::vector<HTTPPathHandler> pathHandlers GUARDED_BY(g_httppathhandlers_m
 //! Bound listening sockets
 static std::vector<evhttp_bound_socket *> boundSockets;
 
+/** An additional event loop, accepting connections on the sockets bound by the main one */
+struct HTTPEventLoop {
+    struct event_base* base;
+    struct evhttp* http;
+    std::vector<evhttp_bound_socket*> bound_sockets;
+    std::thread thread;
+};
+//! Event loops besides the main one, see -rpcioloops
+static std::vector<HTTPEventLoop> g_extra_event_loops;
+
 /**
  * @brief Helps keep track of open `evhttp_connection`s with active `evhttp_requests`
  *
@@ -260,6 +274,53 @@ std::string RequestMethodString(HTTPRequest::RequestMethod m)
     assert(false);
 }
 
+/** HTTP connection close callback */
+static void http_connection_close_cb(evhttp_connection* conn, void*)
+{
+    g_requests.RemoveConnection(conn);
+}
+
+/** State shared by a worker writing a chunked reply and the event loop sending it */
+struct HTTPChunkedReply {
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! Bytes passed to the event loop that have not been handed to libevent yet
+    size_t m_queued GUARDED_BY(m_mutex){0};
+    //! Bytes handed to libevent that have not been written to the socket yet
+    size_t m_buffered GUARDED_BY(m_mutex){0};
+    //! Whether the connection went away before the reply was complete
+    bool m_closed GUARDED_BY(m_mutex){false};
+
+    void Close() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_closed = true);
+        m_cv.notify_all();
+    }
+};
+
+/** Close callback of a connection while a chunked reply is written to it */
+static void http_chunked_connection_close_cb(evhttp_connection* conn, void* arg)
+{
+    static_cast<HTTPChunkedReply*>(arg)->Close();
+    http_connection_close_cb(conn, nullptr);
+}
+
+/** Re-enable reading from the socket. This is the second part of the libevent
+ * workaround in http_request_cb.
+ */
+static void http_enable_read(evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02010900) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** HTTP request callback */
 static void http_request_cb(struct evhttp_request* req, void* arg)
 {
@@ -270,9 +331,7 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
         evhttp_request_set_on_complete_cb(req, [](struct evhttp_request* req, void*) {
             g_requests.RemoveRequest(req);
         }, nullptr);
-        evhttp_connection_set_closecb(conn, [](evhttp_connection* conn, void* arg) {
-            g_requests.RemoveConnection(conn);
-        }, nullptr);
+        evhttp_connection_set_closecb(conn, http_connection_close_cb, nullptr);
     }
 
     // Disable reading to work around a libevent bug, fixed in 2.1.9
@@ -348,9 +407,9 @@ static void http_reject_request_cb(struct evhttp_request* req, void*)
 }
 
 /** Event dispatcher thread */
-static void ThreadHTTP(struct event_base* base)
+static void ThreadHTTP(struct event_base* base, const std::string& thread_name)
 {
-    util::ThreadRename("http");
+    util::ThreadRename(thread_name);
     LogDebug(BCLog::HTTP, "Entering http event loop\n");
     event_base_dispatch(base);
     // Event loop will be interrupted by InterruptHTTPServer()
@@ -440,6 +499,15 @@ static void libevent_log_cb(int severity, const char *msg)
     LogPrintLevel(BCLog::LIBEVENT, level, "%s\n", msg);
 }
 
+/** Apply the server settings and request callback to an evhttp object */
+static void SetupHTTP(struct evhttp* http, const util::SignalInterrupt& interrupt)
+{
+    evhttp_set_timeout(http, gArgs.GetIntArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT));
+    evhttp_set_max_headers_size(http, MAX_HEADERS_SIZE);
+    evhttp_set_max_body_size(http, MAX_SIZE);
+    evhttp_set_gencb(http, http_request_cb, (void*)&interrupt);
+}
+
 bool InitHTTPServer(const util::SignalInterrupt& interrupt)
 {
     if (!InitHTTPAllowList())
@@ -466,16 +534,46 @@ bool InitHTTPServer(const util::SignalInterrupt& interrupt)
         return false;
     }
 
-    evhttp_set_timeout(http, gArgs.GetIntArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT));
-    evhttp_set_max_headers_size(http, MAX_HEADERS_SIZE);
-    evhttp_set_max_body_size(http, MAX_SIZE);
-    evhttp_set_gencb(http, http_request_cb, (void*)&interrupt);
+    SetupHTTP(http, interrupt);
 
     if (!HTTPBindAddresses(http)) {
         LogPrintf("Unable to bind any endpoint for RPC server\n");
         return false;
     }
 
+    const int io_loops = std::max((long)gArgs.GetIntArg("-rpcioloops", DEFAULT_HTTP_IO_LOOPS), 1L);
+#ifndef WIN32
+    for (int i = 1; i < io_loops; i++) {
+        raii_event_base extra_base = obtain_event_base();
+        raii_evhttp extra_http = obtain_evhttp(extra_base.get());
+        if (!extra_http) {
+            LogPrintf("couldn't create evhttp. Exiting.\n");
+            return false;
+        }
+        SetupHTTP(extra_http.get(), interrupt);
+        HTTPEventLoop loop{extra_base.get(), extra_http.get(), {}, {}};
+        for (evhttp_bound_socket* socket : boundSockets) {
+            // Every event loop accepts from the same listening socket, each
+            // through its own descriptor, which libevent closes when done.
+            const evutil_socket_t fd = dup(evhttp_bound_socket_get_fd(socket));
+            evhttp_bound_socket* bind_handle = fd == -1 ? nullptr : evhttp_accept_socket_with_handle(loop.http, fd);
+            if (!bind_handle) {
+                if (fd != -1) close(fd);
+                LogPrintf("Unable to accept RPC connections on event loop %d\n", i);
+                return false;
+            }
+            loop.bound_sockets.push_back(bind_handle);
+        }
+        extra_http.release();
+        extra_base.release();
+        g_extra_event_loops.push_back(std::move(loop));
+    }
+#else
+    if (io_loops > 1) {
+        LogPrintf("WARNING: -rpcioloops is not supported on Windows, using a single event loop\n");
+    }
+#endif
+
     LogDebug(BCLog::HTTP, "Initialized HTTP server\n");
     int workQueueDepth = std::max((long)gArgs.GetIntArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
     LogDebug(BCLog::HTTP, "creating work queue of depth %d\n", workQueueDepth);
@@ -501,8 +599,11 @@ static std::vector<std::thread> g_thread_http_workers;
 void StartHTTPServer()
 {
     int rpcThreads = std::max((long)gArgs.GetIntArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogInfo("Starting HTTP server with %d worker threads\n", rpcThreads);
-    g_thread_http = std::thread(ThreadHTTP, eventBase);
+    LogInfo("Starting HTTP server with %d worker threads and %d event loops\n", rpcThreads, 1 + g_extra_event_loops.size());
+    g_thread_http = std::thread(ThreadHTTP, eventBase, "http");
+    for (size_t i = 0; i < g_extra_event_loops.size(); i++) {
+        g_extra_event_loops[i].thread = std::thread(ThreadHTTP, g_extra_event_loops[i].base, strprintf("http.%i", i + 1));
+    }
 
     for (int i = 0; i < rpcThreads; i++) {
         g_thread_http_workers.emplace_back(HTTPWorkQueueRun, g_work_queue.get(), i);
@@ -516,6 +617,9 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
+    for (const HTTPEventLoop& loop : g_extra_event_loops) {
+        evhttp_set_gencb(loop.http, http_reject_request_cb, nullptr);
+    }
     if (g_work_queue) {
         g_work_queue->Interrupt();
     }
@@ -537,6 +641,12 @@ void StopHTTPServer()
         evhttp_del_accept_socket(eventHTTP, socket);
     }
     boundSockets.clear();
+    for (HTTPEventLoop& loop : g_extra_event_loops) {
+        for (evhttp_bound_socket* socket : loop.bound_sockets) {
+            evhttp_del_accept_socket(loop.http, socket);
+        }
+        loop.bound_sockets.clear();
+    }
     {
         if (const auto n_connections{g_requests.CountActiveConnections()}; n_connections != 0) {
             LogDebug(BCLog::HTTP, "Waiting for %d connections to stop HTTP server\n", n_connections);
@@ -552,6 +662,14 @@ void StopHTTPServer()
             eventHTTP = nullptr;
         }, nullptr, nullptr);
     }
+    for (HTTPEventLoop& loop : g_extra_event_loops) {
+        event_base_once(loop.base, -1, EV_TIMEOUT, [](evutil_socket_t, short, void* http) {
+            evhttp_free(static_cast<struct evhttp*>(http));
+        }, loop.http, nullptr);
+        if (loop.thread.joinable()) loop.thread.join();
+        event_base_free(loop.base);
+    }
+    g_extra_event_loops.clear();
     if (eventBase) {
         LogDebug(BCLog::HTTP, "Waiting for HTTP event thread to exit\n");
         if (g_thread_http.joinable()) g_thread_http.join();
@@ -593,14 +711,27 @@ void HTTPEvent::trigger(struct timeval* tv)
     else
         evtimer_add(ev, tv); // trigger after timeval passed
 }
+/** Event loop that received a request. libevent's connection state is only
+ * safe to read from that loop's thread.
+ */
+static struct event_base* GetRequestEventBase(struct evhttp_request* req)
+{
+    evhttp_connection* conn = evhttp_request_get_connection(req);
+    return conn ? evhttp_connection_get_base(conn) : eventBase;
+}
+
 HTTPRequest::HTTPRequest(struct evhttp_request* _req, const util::SignalInterrupt& interrupt, bool _replySent)
-    : req(_req), m_interrupt(interrupt), replySent(_replySent)
+    : req(_req), m_base(GetRequestEventBase(_req)), m_interrupt(interrupt), replySent(_replySent)
 {
 }
 
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (!replySent && m_chunked) {
+        // A chunked reply was started but not completed, for example because
+        // the client went away
+        EndChunkedReply();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL_SERVER_ERROR, "Unhandled request");
@@ -625,17 +756,17 @@ std::string HTTPRequest::ReadBody()
     if (!buf)
         return "";
     size_t size = evbuffer_get_length(buf);
-    /** Trivial implementation: if this is ever a performance bottleneck,
-     * internal copying can be avoided in multi-segment buffers by using
-     * evbuffer_peek and an awkward loop. Though in that case, it'd be even
-     * better to not copy into an intermediate string but use a stream
-     * abstraction to consume the evbuffer on the fly in the parsing algorithm.
+    if (size == 0)
+        return "";
+    /** Copy the segments of the buffer straight into the string, instead of
+     * first making the buffer contiguous with evbuffer_pullup, which copies
+     * multi-segment buffers once more. It'd be even better to not copy into
+     * an intermediate string but use a stream abstraction to consume the
+     * evbuffer on the fly in the parsing algorithm.
      */
-    const char* data = (const char*)evbuffer_pullup(buf, size);
-    if (!data) // returns nullptr in case of empty buffer
+    std::string rv(size, '\0');
+    if (evbuffer_remove(buf, rv.data(), size) != (int)size)
         return "";
-    std::string rv(data, size);
-    evbuffer_drain(buf, size);
     return rv;
 }
 
@@ -654,31 +785,134 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 void HTTPRequest::WriteReply(int nStatus, std::span<const std::byte> reply)
 {
     assert(!replySent && req);
-    if (m_interrupt) {
-        WriteHeader("Connection", "close");
-    }
-    // Send event to main http thread to send reply message
     struct evbuffer* evb = evhttp_request_get_output_buffer(req);
     assert(evb);
     evbuffer_add(evb, reply.data(), reply.size());
+    SendReply(nStatus);
+}
+
+void HTTPRequest::WriteOwnedReply(int nStatus, std::unique_ptr<std::string> reply)
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    if (!reply->empty()) {
+        // The string is freed by libevent once the reply has been sent.
+        std::string* body = reply.release();
+        evbuffer_add_reference(evb, body->data(), body->size(), [](const void*, size_t, void* extra) {
+            delete static_cast<std::string*>(extra);
+        }, body);
+    }
+    SendReply(nStatus);
+}
+
+/** Closure sent to the event loop thread of the request to send the reply.
+ * Replies must be sent in the event loop that received the request,
+ * this cannot be done from worker threads.
+ */
+void HTTPRequest::SendReply(int nStatus)
+{
+    if (m_interrupt) {
+        WriteHeader("Connection", "close");
+    }
+    // Send event to the request's http thread to send reply message
     auto req_copy = req;
-    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
+    HTTPEvent* ev = new HTTPEvent(m_base, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02010900) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
+        http_enable_read(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to the event loop thread
+}
+
+void HTTPRequest::StartChunkedReply(int nStatus)
+{
+    assert(!replySent && !m_chunked && req);
+    if (m_interrupt) {
+        WriteHeader("Connection", "close");
+    }
+    m_chunked = std::make_shared<HTTPChunkedReply>();
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(m_base, true, [req_copy, nStatus, chunked = m_chunked]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (!conn) {
+            chunked->Close();
+            return;
+        }
+        // Wake up the writer if the client goes away while the reply is written.
+        evhttp_connection_set_closecb(conn, http_chunked_connection_close_cb, chunked.get());
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+}
+
+bool HTTPRequest::WriteReplyChunk(std::string chunk)
+{
+    assert(!replySent && m_chunked && req);
+    if (chunk.empty()) return true;
+    {
+        WAIT_LOCK(m_chunked->m_mutex, lock);
+        while (!m_chunked->m_closed && m_chunked->m_queued + m_chunked->m_buffered > MAX_CHUNKED_REPLY_PENDING) {
+            if (m_interrupt) return false;
+            m_chunked->m_cv.wait_for(lock, std::chrono::milliseconds{100});
+        }
+        if (m_chunked->m_closed) return false;
+        m_chunked->m_queued += chunk.size();
+    }
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(m_base, true, [req_copy, chunked = m_chunked, body = std::make_shared<std::string>(std::move(chunk))]{
+        {
+            LOCK(chunked->m_mutex);
+            chunked->m_queued -= body->size();
+            if (chunked->m_closed || !evhttp_request_get_connection(req_copy)) {
+                chunked->m_closed = true;
+                chunked->m_cv.notify_all();
+                return;
             }
+            chunked->m_buffered += body->size();
+        }
+        // The string is freed by libevent once the chunk has been sent.
+        std::string* data = new std::string(std::move(*body));
+        struct evbuffer* evb = evbuffer_new();
+        assert(evb);
+        evbuffer_add_reference(evb, data->data(), data->size(), [](const void*, size_t, void* extra) {
+            delete static_cast<std::string*>(extra);
+        }, data);
+        // The callback is called once everything handed to libevent so far has been written.
+        evhttp_send_reply_chunk_with_cb(req_copy, evb, [](evhttp_connection*, void* arg) {
+            HTTPChunkedReply* chunked = static_cast<HTTPChunkedReply*>(arg);
+            WITH_LOCK(chunked->m_mutex, chunked->m_buffered = 0);
+            chunked->m_cv.notify_all();
+        }, chunked.get());
+        evbuffer_free(evb);
+    });
+    ev->trigger(nullptr);
+    return true;
+}
+
+bool HTTPRequest::IsChunkedReplyClosed() const
+{
+    assert(!replySent && m_chunked);
+    return WITH_LOCK(m_chunked->m_mutex, return m_chunked->m_closed);
+}
+
+void HTTPRequest::EndChunkedReply()
+{
+    assert(!replySent && m_chunked && req);
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(m_base, true, [req_copy, chunked = m_chunked]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, http_connection_close_cb, nullptr);
+            http_enable_read(req_copy);
         }
+        // Frees the request if the connection has gone away.
+        evhttp_send_reply_end(req_copy);
     });
     ev->trigger(nullptr);
     replySent = true;
-    req = nullptr; // transferred back to main thread
+    req = nullptr; // transferred back to the event loop thread
 }
 
 CService HTTPRequest::GetPeer() const
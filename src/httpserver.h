@@ -5,7 +5,9 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <concepts>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <span>
 #include <string>
@@ -27,10 +29,17 @@ static const int DEFAULT_HTTP_WORKQUEUE=64;
 
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
+/**
+ * The default value for `-rpcioloops`. This is the number of event loop threads
+ * accepting connections and reading and writing HTTP messages.
+ */
+static const int DEFAULT_HTTP_IO_LOOPS=1;
+
 struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+struct HTTPChunkedReply;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -71,8 +80,16 @@ class HTTPRequest
 {
 private:
     struct evhttp_request* req;
+    //! Event loop that received the request, captured on its thread by the constructor.
+    struct event_base* const m_base;
     const util::SignalInterrupt& m_interrupt;
     bool replySent;
+    //! State of a reply sent in chunks, null unless StartChunkedReply was called.
+    std::shared_ptr<HTTPChunkedReply> m_chunked;
+
+    void WriteOwnedReply(int nStatus, std::unique_ptr<std::string> reply);
+    //! Hand the request back to its event loop thread to send the reply.
+    void SendReply(int nStatus);
 
 public:
     explicit HTTPRequest(struct evhttp_request* req, const util::SignalInterrupt& interrupt, bool replySent = false);
@@ -143,6 +160,42 @@ public:
         WriteReply(nStatus, std::as_bytes(std::span{reply}));
     }
     void WriteReply(int nStatus, std::span<const std::byte> reply);
+    /**
+     * Write HTTP reply, taking ownership of a string body. The body is handed
+     * to libevent as is, instead of being copied into the output buffer.
+     */
+    template <std::same_as<std::string> T>
+    void WriteReply(int nStatus, T&& reply)
+    {
+        WriteOwnedReply(nStatus, std::make_unique<std::string>(std::move(reply)));
+    }
+
+    /**
+     * Start an HTTP reply whose body is written in pieces with WriteReplyChunk,
+     * using chunked transfer encoding. This sends the status and headers.
+     * EndChunkedReply completes the reply, and is called by the destructor if
+     * it was not called before.
+     */
+    void StartChunkedReply(int nStatus);
+    /**
+     * Write a piece of the body of a reply started with StartChunkedReply.
+     * Blocks while too much of the reply is waiting to be written to the
+     * socket, so a slow client keeps the memory used by the reply bounded.
+     *
+     * @return false if the client went away or the server is shutting down,
+     * in which case the rest of the reply should not be generated.
+     */
+    bool WriteReplyChunk(std::string chunk);
+    /**
+     * Whether the client of a reply started with StartChunkedReply went away,
+     * so the rest of the reply would not be sent.
+     */
+    bool IsChunkedReplyClosed() const;
+    /**
+     * Complete a reply started with StartChunkedReply. As with WriteReply, do
+     * not call any other HTTPRequest methods after calling this.
+     */
+    void EndChunkedReply();
 };
 
 /** Get the query parameter value from request uri for a specified key, or std::nullopt if the key
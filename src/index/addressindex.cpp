@@ -0,0 +1,182 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/addressindex.h>
+
+#include <coins.h>
+#include <common/args.h>
+#include <crypto/sha256.h>
+#include <dbwrapper.h>
+#include <interfaces/chain.h>
+#include <logging.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <undo.h>
+#include <util/fs.h>
+
+#include <ios>
+#include <utility>
+
+/**
+ * Keys of the address index have the type [DB_ADDRESS, uint256 script hash, uint32 height (BE),
+ * uint32 tx position (BE), uint8 spending, uint32 input or output index (BE)] and map to the
+ * txid and the amount. The big-endian fields keep the entries of a script sorted by their
+ * position in the chain.
+ */
+constexpr uint8_t DB_ADDRESS{'a'};
+
+std::unique_ptr<AddressIndex> g_address_index;
+
+namespace {
+
+struct DBKey {
+    uint256 script_hash;
+    AddressIndexEntry entry;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_ADDRESS);
+        s << script_hash;
+        ser_writedata32be(s, entry.height);
+        ser_writedata32be(s, entry.tx_pos);
+        ser_writedata8(s, entry.spending);
+        ser_writedata32be(s, entry.index);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_ADDRESS) {
+            throw std::ios_base::failure("Invalid format for address index DB key");
+        }
+        s >> script_hash;
+        entry.height = ser_readdata32be(s);
+        entry.tx_pos = ser_readdata32be(s);
+        entry.spending = ser_readdata8(s);
+        entry.index = ser_readdata32be(s);
+    }
+};
+
+struct DBVal {
+    Txid txid;
+    CAmount amount;
+
+    SERIALIZE_METHODS(DBVal, obj) { READWRITE(obj.txid, obj.amount); }
+};
+
+/** Whether two entries are at the same position in the history of a script. */
+bool SamePosition(const AddressIndexEntry& a, const AddressIndexEntry& b)
+{
+    return a.height == b.height && a.tx_pos == b.tx_pos && a.spending == b.spending && a.index == b.index;
+}
+
+uint256 ScriptHash(const CScript& script)
+{
+    uint256 hash;
+    CSHA256().Write(script.data(), script.size()).Finalize(hash.begin());
+    return hash;
+}
+
+/** Call fn(key) for every entry the block adds to the index. */
+template <typename Fn>
+void ForEachBlockEntry(const interfaces::BlockInfo& block, Fn&& fn)
+{
+    assert(block.data);
+    assert(block.undo_data);
+    for (uint32_t tx_pos{0}; tx_pos < block.data->vtx.size(); ++tx_pos) {
+        const CTransaction& tx{*block.data->vtx[tx_pos]};
+        for (uint32_t n{0}; n < tx.vout.size(); ++n) {
+            const CTxOut& out{tx.vout[n]};
+            if (out.scriptPubKey.IsUnspendable()) continue;
+            fn(DBKey{ScriptHash(out.scriptPubKey), {block.height, tx_pos, /*spending=*/false, n, tx.GetHash(), out.nValue}});
+        }
+        if (tx.IsCoinBase()) continue;
+        const CTxUndo& tx_undo{block.undo_data->vtxundo.at(tx_pos - 1)};
+        for (uint32_t n{0}; n < tx.vin.size(); ++n) {
+            const CTxOut& spent{tx_undo.vprevout.at(n).out};
+            fn(DBKey{ScriptHash(spent.scriptPubKey), {block.height, tx_pos, /*spending=*/true, n, tx.GetHash(), spent.nValue}});
+        }
+    }
+}
+
+} // namespace
+
+/** Access to the address index database (indexes/addressindex/) */
+class AddressIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+AddressIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "addressindex", n_cache_size, f_memory, f_wipe)
+{}
+
+AddressIndex::AddressIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "addressindex"), m_db(std::make_unique<AddressIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+AddressIndex::~AddressIndex() = default;
+
+interfaces::Chain::NotifyOptions AddressIndex::CustomOptions()
+{
+    interfaces::Chain::NotifyOptions options;
+    options.connect_undo_data = true;
+    options.disconnect_data = true;
+    options.disconnect_undo_data = true;
+    return options;
+}
+
+bool AddressIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (block.height == 0) return true;
+
+    CDBBatch batch(*m_db);
+    ForEachBlockEntry(block, [&](const DBKey& key) {
+        batch.Write(key, DBVal{key.entry.txid, key.entry.amount});
+    });
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::CustomRemove(const interfaces::BlockInfo& block)
+{
+    if (block.height == 0) return true;
+
+    CDBBatch batch(*m_db);
+    ForEachBlockEntry(block, [&](const DBKey& key) {
+        batch.Erase(key);
+    });
+    return m_db->WriteBatch(batch);
+}
+
+BaseIndex::DB& AddressIndex::GetDB() const { return *m_db; }
+
+bool AddressIndex::LookupScript(const CScript& script, const AddressIndexEntry* after, size_t count, std::vector<AddressIndexEntry>& entries) const
+{
+    const uint256 script_hash{ScriptHash(script)};
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    if (after) {
+        db_it->Seek(DBKey{script_hash, *after});
+    } else {
+        db_it->Seek(std::make_pair(DB_ADDRESS, script_hash));
+    }
+    for (; db_it->Valid() && entries.size() < count; db_it->Next()) {
+        DBKey key;
+        if (!db_it->GetKey(key) || key.script_hash != script_hash) break;
+        if (after && SamePosition(key.entry, *after)) continue;
+        DBVal value;
+        if (!db_it->GetValue(value)) {
+            LogError("Cannot read address index entry for script hash %s", script_hash.ToString());
+            return false;
+        }
+        key.entry.txid = value.txid;
+        key.entry.amount = value.amount;
+        entries.push_back(key.entry);
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_ADDRESSINDEX_H
+#define BITCOIN_INDEX_ADDRESSINDEX_H
+
+#include <consensus/amount.h>
+#include <index/base.h>
+#include <primitives/transaction.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class CScript;
+
+static constexpr bool DEFAULT_ADDRESSINDEX{false};
+//! Maximum number of entries returned by one address history lookup over RPC or REST
+static constexpr unsigned int MAX_ADDRESS_HISTORY_RESULTS{1000};
+
+/** A transaction output funding a script, or a transaction input spending from it. */
+struct AddressIndexEntry {
+    //! Height of the block containing the transaction.
+    int height{0};
+    //! Position of the transaction within its block.
+    uint32_t tx_pos{0};
+    //! Whether the transaction spends from the script (true) or funds it (false).
+    bool spending{false};
+    //! The input index if spending, the output index if funding.
+    uint32_t index{0};
+    Txid txid;
+    CAmount amount{0};
+};
+
+/**
+ * AddressIndex records, for every scriptPubKey, the transactions in the active
+ * chain that fund it and spend from it. Entries are keyed by the SHA256 of the
+ * script and ordered by block height and position within the block, so the
+ * history of a script is read sequentially, oldest first.
+ *
+ * Entries only record the height of their block. Callers that need the block
+ * hash take it from the active chain, for heights up to where it forks from the
+ * index's best block read before the lookup.
+ */
+class AddressIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    bool AllowPrune() const override { return false; }
+
+protected:
+    interfaces::Chain::NotifyOptions CustomOptions() override;
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRemove(const interfaces::BlockInfo& block) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~AddressIndex() override;
+
+    /// Look up the history of a script, oldest first.
+    ///
+    /// @param[in]   script  The scriptPubKey to look up.
+    /// @param[in]   after  If set, only entries that come after the position (height, tx_pos,
+    ///                     spending and index) of this entry are returned. Seeks directly to
+    ///                     it, so paging through a long history stays cheap.
+    /// @param[in]   count  Maximum number of entries to return.
+    /// @param[out]  entries  The entries found.
+    /// @return  false if the index could not be read, true otherwise
+    bool LookupScript(const CScript& script, const AddressIndexEntry* after, size_t count, std::vector<AddressIndexEntry>& entries) const;
+};
+
+/// The global address index. May be null.
+extern std::unique_ptr<AddressIndex> g_address_index;
+
+#endif // BITCOIN_INDEX_ADDRESSINDEX_H
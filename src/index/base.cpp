@@ -13,25 +13,138 @@
 #include <node/context.h>
 #include <node/database_args.h>
 #include <node/interface_ui.h>
+#include <sync.h>
 #include <tinyformat.h>
 #include <undo.h>
 #include <util/string.h>
 #include <util/thread.h>
+#include <util/threadpool.h>
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 constexpr uint8_t DB_BEST_BLOCK{'B'};
 
 constexpr auto SYNC_LOG_INTERVAL{30s};
 constexpr auto SYNC_LOCATOR_WRITE_INTERVAL{30s};
+//! Number of blocks read from disk at once while syncing, split between the indexes syncing at
+//! the same time. The next batch is read while the current one is being indexed.
+constexpr size_t SYNC_READ_AHEAD_BLOCKS{32};
+//! Minimum number of blocks read at once by each syncing index
+constexpr size_t MIN_SYNC_READ_AHEAD_BLOCKS{4};
+//! Number of threads reading blocks from disk for all syncing indexes together.
+constexpr int SYNC_READ_THREADS{3};
+
+namespace {
+//! A block (and its undo data, if the index needs it) read from disk ahead of being indexed.
+struct PrefetchedBlock {
+    const CBlockIndex* pindex;
+    CBlock block;
+    CBlockUndo undo;
+    //! Whether the block was read successfully. If not, it is read again when it is processed,
+    //! so that a failure is reported for the block the index actually got to.
+    bool read{false};
+
+    explicit PrefetchedBlock(const CBlockIndex* pindex_in) : pindex{pindex_in} {}
+};
+
+GlobalMutex g_sync_readers_mutex;
+std::weak_ptr<util::ThreadPool> g_sync_read_pool GUARDED_BY(g_sync_readers_mutex);
+int g_syncing_indexes GUARDED_BY(g_sync_readers_mutex){0};
+
+/**
+ * The threads reading blocks from disk, shared by all indexes that are syncing
+ * at the same time. Each of them holds one while it syncs, and the threads
+ * stop once none does.
+ */
+class SyncReaders
+{
+    std::shared_ptr<util::ThreadPool> m_pool;
+
+public:
+    SyncReaders() EXCLUSIVE_LOCKS_REQUIRED(!g_sync_readers_mutex)
+    {
+        LOCK(g_sync_readers_mutex);
+        ++g_syncing_indexes;
+        m_pool = g_sync_read_pool.lock();
+        if (!m_pool) {
+            m_pool = std::make_shared<util::ThreadPool>(SYNC_READ_THREADS, "idxread");
+            g_sync_read_pool = m_pool;
+        }
+    }
+
+    ~SyncReaders() EXCLUSIVE_LOCKS_REQUIRED(!g_sync_readers_mutex)
+    {
+        LOCK(g_sync_readers_mutex);
+        --g_syncing_indexes;
+    }
+
+    util::ThreadPool& Pool() { return *m_pool; }
+
+    //! Number of blocks to read at once, so that the blocks held in memory do not grow with the number of syncing indexes
+    static size_t ReadAheadBlocks() EXCLUSIVE_LOCKS_REQUIRED(!g_sync_readers_mutex)
+    {
+        LOCK(g_sync_readers_mutex);
+        return std::max(SYNC_READ_AHEAD_BLOCKS / std::max(g_syncing_indexes, 1), MIN_SYNC_READ_AHEAD_BLOCKS);
+    }
+};
+
+/**
+ * Consecutive blocks of the active chain, read from disk by the reader threads.
+ * Blocks that fail to read are left marked as unread.
+ */
+class ReadAheadBatch
+{
+    Mutex m_mutex;
+    std::condition_variable m_cond GUARDED_BY(m_mutex);
+    size_t m_pending GUARDED_BY(m_mutex){0};
+
+public:
+    std::vector<PrefetchedBlock> blocks;
+
+    /** Start reading pindex and up to max_blocks - 1 of its successors. */
+    ReadAheadBatch(const CBlockIndex* pindex, size_t max_blocks, bool read_undo, Chainstate& chainstate, util::ThreadPool& pool)
+        EXCLUSIVE_LOCKS_REQUIRED(!cs_main, !m_mutex)
+    {
+        {
+            LOCK(cs_main);
+            for (const CBlockIndex* it{pindex}; it && blocks.size() < max_blocks; it = chainstate.m_chain.Next(it)) {
+                blocks.emplace_back(it);
+            }
+        }
+        // The reads point into `blocks`, so it must not be resized from here on.
+        WITH_LOCK(m_mutex, m_pending = blocks.size());
+        for (PrefetchedBlock& prefetched : blocks) {
+            pool.Submit([this, &prefetched, &blockman = chainstate.m_blockman, read_undo] {
+                const CBlockIndex& index{*prefetched.pindex};
+                prefetched.read = blockman.ReadBlock(prefetched.block, index) &&
+                                  (!read_undo || index.nHeight == 0 || blockman.ReadBlockUndo(prefetched.undo, index));
+                LOCK(m_mutex);
+                if (--m_pending == 0) m_cond.notify_all();
+            });
+        }
+    }
+
+    ~ReadAheadBatch() { Wait(); }
+
+    //! Wait until every block has been read.
+    void Wait() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        while (m_pending > 0) m_cond.wait(lock);
+    }
+};
+} // namespace
 
 template <typename... Args>
 void BaseIndex::FatalErrorf(util::ConstevalFormatString<sizeof...(Args)> fmt, const Args&... args)
@@ -149,7 +262,7 @@ static const CBlockIndex* NextSyncBlock(const CBlockIndex* pindex_prev, CChain&
     return chain.Next(chain.FindFork(pindex_prev));
 }
 
-bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data)
+bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data, const CBlockUndo* undo_data)
 {
     interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex, block_data);
 
@@ -165,12 +278,15 @@ bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data
 
     CBlockUndo block_undo;
     if (CustomOptions().connect_undo_data) {
-        if (pindex->nHeight > 0 && !m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
-            FatalErrorf("Failed to read undo block data %s from disk",
-                        pindex->GetBlockHash().ToString());
-            return false;
+        if (!undo_data) { // disk lookup if undo data wasn't provided
+            if (pindex->nHeight > 0 && !m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
+                FatalErrorf("Failed to read undo block data %s from disk",
+                            pindex->GetBlockHash().ToString());
+                return false;
+            }
+            undo_data = &block_undo;
         }
-        block_info.undo_data = &block_undo;
+        block_info.undo_data = undo_data;
     }
 
     if (!CustomAppend(block_info)) {
@@ -186,6 +302,15 @@ void BaseIndex::Sync()
 {
     const CBlockIndex* pindex = m_best_block_index.load();
     if (!m_synced) {
+        // Blocks are read from disk in parallel batches and then appended to the
+        // index one at a time in chain order. While one batch is being appended,
+        // the next one is read in the background.
+        SyncReaders readers;
+        const bool read_undo{CustomOptions().connect_undo_data};
+        // Declared after the readers, so that pending reads finish before the reader threads may stop.
+        std::unique_ptr<ReadAheadBatch> read_ahead, next_read_ahead;
+        size_t read_ahead_pos{0};
+
         std::chrono::steady_clock::time_point last_log_time{0s};
         std::chrono::steady_clock::time_point last_locator_write_time{0s};
         while (true) {
@@ -226,8 +351,22 @@ void BaseIndex::Sync()
             }
             pindex = pindex_next;
 
-
-            if (!ProcessBlock(pindex)) return; // error logged internally
+            // Move on to the next batch when the current one is exhausted, or when the
+            // chain moved away from the blocks it holds. The next batch is only used if
+            // it starts at the block to index, otherwise it is read again from there.
+            if (!read_ahead || read_ahead_pos == read_ahead->blocks.size() || read_ahead->blocks[read_ahead_pos].pindex != pindex) {
+                read_ahead = std::move(next_read_ahead);
+                if (!read_ahead || read_ahead->blocks.front().pindex != pindex) {
+                    read_ahead = std::make_unique<ReadAheadBatch>(pindex, SyncReaders::ReadAheadBlocks(), read_undo, *m_chainstate, readers.Pool());
+                }
+                read_ahead_pos = 0;
+                const CBlockIndex* next{WITH_LOCK(cs_main, return m_chainstate->m_chain.Next(read_ahead->blocks.back().pindex))};
+                next_read_ahead = next ? std::make_unique<ReadAheadBatch>(next, SyncReaders::ReadAheadBlocks(), read_undo, *m_chainstate, readers.Pool()) : nullptr;
+                read_ahead->Wait();
+            }
+            const PrefetchedBlock& prefetched{read_ahead->blocks[read_ahead_pos++]};
+            if (!ProcessBlock(pindex, prefetched.read ? &prefetched.block : nullptr,
+                              prefetched.read ? &prefetched.undo : nullptr)) return; // error logged internally
 
             auto current_time{std::chrono::steady_clock::now()};
             if (last_log_time + SYNC_LOG_INTERVAL < current_time) {
@@ -16,6 +16,7 @@
 
 class CBlock;
 class CBlockIndex;
+class CBlockUndo;
 class Chainstate;
 class ChainstateManager;
 namespace interfaces {
@@ -93,7 +94,7 @@ private:
     /// Loop over disconnected blocks and call CustomRemove.
     bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip);
 
-    bool ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data = nullptr);
+    bool ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data = nullptr, const CBlockUndo* undo_data = nullptr);
 
     virtual bool AllowPrune() const = 0;
 
@@ -6,12 +6,76 @@
 
 #include <clientversion.h>
 #include <common/args.h>
+#include <crypto/common.h>
 #include <index/disktxpos.h>
 #include <logging.h>
 #include <node/blockstorage.h>
+#include <node/interface_ui.h>
+#include <serialize.h>
+#include <util/translation.h>
 #include <validation.h>
 
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * The index is stored under compact keys of the type [DB_TXINDEX_COMPACT, 8-byte txid prefix,
+ * CDiskTxPos] with an empty value. Putting the position in the key rather than the value lets
+ * transactions that share a prefix coexist without a read-modify-write on every append; lookups
+ * iterate over the entries for the prefix and resolve false positives by reading each candidate
+ * transaction from disk, which FindTx has to do anyway.
+ *
+ * Indexes built by earlier versions use keys of the type [DB_TXINDEX, uint256] mapping to a
+ * CDiskTxPos. They are still read, so an existing index keeps working and is only extended with
+ * compact entries. Whether any of them exist is checked once on startup rather than on every
+ * lookup; a downgraded node may have added some since the last run, so it isn't persisted.
+ *
+ * Entries of blocks that are disconnected are removed again, so that lookups don't have to skip
+ * over copies of transactions in stale blocks.
+ *
+ * DB_TXINDEX_VERSION records the newest format the index may contain. Versions that predate it
+ * ignore it and the compact entries, so after downgrading to one of them lookups of
+ * transactions indexed since the upgrade fail until the index is rebuilt with -reindex.
+ * Versions that know about it refuse to use an index written in a format newer than theirs.
+ */
 constexpr uint8_t DB_TXINDEX{'t'};
+constexpr uint8_t DB_TXINDEX_COMPACT{'T'};
+constexpr uint8_t DB_TXINDEX_VERSION{'V'};
+
+//! Format version of the entries written by this version: 1 for compact keys.
+constexpr uint32_t TXINDEX_VERSION{1};
+
+namespace {
+
+struct DBCompactKey {
+    uint64_t txid_prefix;
+    CDiskTxPos pos;
+
+    DBCompactKey() = default;
+    DBCompactKey(const uint256& txid, const CDiskTxPos& pos_in) : txid_prefix{ReadLE64(txid.begin())}, pos{pos_in} {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_TXINDEX_COMPACT);
+        ser_writedata64(s, txid_prefix);
+        s << pos;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_TXINDEX_COMPACT) {
+            throw std::ios_base::failure("Invalid format for txindex DB compact key");
+        }
+        txid_prefix = ser_readdata64(s);
+        s >> pos;
+    }
+};
+
+} // namespace
 
 std::unique_ptr<TxIndex> g_txindex;
 
@@ -22,43 +86,115 @@ class TxIndex::DB : public BaseIndex::DB
 public:
     explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
 
-    /// Read the disk location of the transaction data with the given hash. Returns false if the
-    /// transaction hash is not indexed.
-    bool ReadTxPos(const uint256& txid, CDiskTxPos& pos) const;
+    /// Read the disk locations of the transactions whose hash shares its prefix with the given
+    /// hash. Entries written by earlier versions are matched on the full hash.
+    std::vector<CDiskTxPos> ReadTxPos(const uint256& txid);
 
     /// Write a batch of transaction positions to the DB.
     [[nodiscard]] bool WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos);
+
+    /// Erase a batch of transaction positions from the DB, including entries written by
+    /// earlier versions that point to the same position.
+    [[nodiscard]] bool EraseTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos);
+
+    /// Check that the index format is one this version can read, and record that it may
+    /// contain entries in this version's format.
+    [[nodiscard]] bool CheckAndWriteVersion();
+
+private:
+    /// Whether the index contains entries written by earlier versions, set by
+    /// CheckAndWriteVersion.
+    bool m_has_legacy_entries{true};
 };
 
 TxIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
     BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "txindex", n_cache_size, f_memory, f_wipe)
 {}
 
-bool TxIndex::DB::ReadTxPos(const uint256 &txid, CDiskTxPos& pos) const
+std::vector<CDiskTxPos> TxIndex::DB::ReadTxPos(const uint256& txid)
 {
-    return Read(std::make_pair(DB_TXINDEX, txid), pos);
+    std::vector<CDiskTxPos> ret;
+    const uint64_t txid_prefix{ReadLE64(txid.begin())};
+    std::unique_ptr<CDBIterator> db_it(NewIterator());
+    for (db_it->Seek(std::make_pair(DB_TXINDEX_COMPACT, txid_prefix)); db_it->Valid(); db_it->Next()) {
+        DBCompactKey key;
+        if (!db_it->GetKey(key) || key.txid_prefix != txid_prefix) break;
+        ret.push_back(key.pos);
+    }
+
+    CDiskTxPos legacy_pos;
+    if (m_has_legacy_entries && Read(std::make_pair(DB_TXINDEX, txid), legacy_pos)) {
+        ret.push_back(legacy_pos);
+    }
+    return ret;
 }
 
 bool TxIndex::DB::WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos)
 {
     CDBBatch batch(*this);
     for (const auto& tuple : v_pos) {
-        batch.Write(std::make_pair(DB_TXINDEX, tuple.first), tuple.second);
+        batch.Write(DBCompactKey(tuple.first, tuple.second), uint8_t{0});
+    }
+    return WriteBatch(batch);
+}
+
+bool TxIndex::DB::EraseTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos)
+{
+    CDBBatch batch(*this);
+    for (const auto& [txid, pos] : v_pos) {
+        batch.Erase(DBCompactKey(txid, pos));
+        CDiskTxPos legacy_pos;
+        if (m_has_legacy_entries && Read(std::make_pair(DB_TXINDEX, txid), legacy_pos) &&
+            legacy_pos == pos && legacy_pos.nTxOffset == pos.nTxOffset) {
+            batch.Erase(std::make_pair(DB_TXINDEX, txid));
+        }
     }
     return WriteBatch(batch);
 }
 
+bool TxIndex::DB::CheckAndWriteVersion()
+{
+    std::unique_ptr<CDBIterator> db_it(NewIterator());
+    db_it->Seek(DB_TXINDEX);
+    std::pair<uint8_t, uint256> key;
+    m_has_legacy_entries = db_it->Valid() && db_it->GetKey(key) && key.first == DB_TXINDEX;
+
+
+    uint32_t version{0};
+    if (!Read(DB_TXINDEX_VERSION, version) && Exists(DB_TXINDEX_VERSION)) {
+        LogError("Cannot read txindex version; index may be corrupted");
+        return false;
+    }
+    if (version > TXINDEX_VERSION) {
+        return InitError(Untranslated(strprintf("txindex was written in format version %d, which this version does not support. Please rebuild the index.", version)));
+    }
+    if (version < TXINDEX_VERSION) {
+        return Write(DB_TXINDEX_VERSION, TXINDEX_VERSION, /*fSync=*/true);
+    }
+    return true;
+}
+
 TxIndex::TxIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
     : BaseIndex(std::move(chain), "txindex"), m_db(std::make_unique<TxIndex::DB>(n_cache_size, f_memory, f_wipe))
 {}
 
 TxIndex::~TxIndex() = default;
 
-bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
+bool TxIndex::CustomInit(const std::optional<interfaces::BlockRef>& block)
 {
-    // Exclude genesis block transaction because outputs are not spendable.
-    if (block.height == 0) return true;
+    return m_db->CheckAndWriteVersion();
+}
+
+interfaces::Chain::NotifyOptions TxIndex::CustomOptions()
+{
+    interfaces::Chain::NotifyOptions options;
+    options.disconnect_data = true;
+    return options;
+}
 
+/** Disk locations of the transactions of a block, as indexed. */
+static std::vector<std::pair<uint256, CDiskTxPos>> GetTxPositions(const interfaces::BlockInfo& block)
+{
     assert(block.data);
     CDiskTxPos pos({block.file_number, block.data_pos}, GetSizeOfCompactSize(block.data->vtx.size()));
     std::vector<std::pair<uint256, CDiskTxPos>> vPos;
@@ -67,18 +203,26 @@ bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
         vPos.emplace_back(tx->GetHash(), pos);
         pos.nTxOffset += ::GetSerializeSize(TX_WITH_WITNESS(*tx));
     }
-    return m_db->WriteTxs(vPos);
+    return vPos;
 }
 
-BaseIndex::DB& TxIndex::GetDB() const { return *m_db; }
+bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (block.height == 0) return true;
 
-bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const
+    return m_db->WriteTxs(GetTxPositions(block));
+}
+
+bool TxIndex::CustomRemove(const interfaces::BlockInfo& block)
 {
-    CDiskTxPos postx;
-    if (!m_db->ReadTxPos(tx_hash, postx)) {
-        return false;
-    }
+    return m_db->EraseTxs(GetTxPositions(block));
+}
 
+BaseIndex::DB& TxIndex::GetDB() const { return *m_db; }
+
+bool TxIndex::ReadTx(const CDiskTxPos& postx, uint256& block_hash, CTransactionRef& tx) const
+{
     AutoFile file{m_chainstate->m_blockman.OpenBlockFile(postx, true)};
     if (file.IsNull()) {
         LogError("OpenBlockFile failed");
@@ -93,10 +237,39 @@ bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRe
         LogError("Deserialize or I/O error - %s", e.what());
         return false;
     }
-    if (tx->GetHash() != tx_hash) {
-        LogError("txid mismatch");
-        return false;
-    }
     block_hash = header.GetHash();
     return true;
 }
+
+bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const
+{
+    // A transaction can be indexed more than once if it was included in a block that was
+    // reorganized out while the index wasn't running, or by a version that didn't remove
+    // entries of disconnected blocks. Prefer the copy in the active chain.
+    std::optional<std::pair<uint256, CTransactionRef>> fallback;
+    for (const CDiskTxPos& postx : m_db->ReadTxPos(tx_hash)) {
+        uint256 candidate_block_hash;
+        CTransactionRef candidate_tx;
+        // A candidate that can't be read doesn't rule out the others.
+        if (!ReadTx(postx, candidate_block_hash, candidate_tx)) continue;
+        // Another transaction sharing the key prefix.
+        if (candidate_tx->GetHash() != tx_hash) continue;
+
+        bool in_active_chain;
+        {
+            LOCK(::cs_main);
+            const CBlockIndex* pindex{m_chainstate->m_blockman.LookupBlockIndex(candidate_block_hash)};
+            in_active_chain = pindex && m_chainstate->m_chain.Contains(pindex);
+        }
+        if (in_active_chain) {
+            block_hash = candidate_block_hash;
+            tx = std::move(candidate_tx);
+            return true;
+        }
+        if (!fallback) fallback.emplace(candidate_block_hash, std::move(candidate_tx));
+    }
+    if (!fallback) return false;
+    block_hash = fallback->first;
+    tx = std::move(fallback->second);
+    return true;
+}
@@ -7,12 +7,15 @@
 
 #include <index/base.h>
 
+struct CDiskTxPos;
+
 static constexpr bool DEFAULT_TXINDEX{false};
 
 /**
  * TxIndex is used to look up transactions included in the blockchain by hash.
  * The index is written to a LevelDB database and records the filesystem
- * location of each transaction by transaction hash.
+ * location of each transaction, keyed by a short prefix of the transaction
+ * hash. Prefix collisions are resolved by reading the transaction from disk.
  */
 class TxIndex final : public BaseIndex
 {
@@ -24,9 +27,18 @@ private:
 
     bool AllowPrune() const override { return false; }
 
+    /// Read the transaction at the given position and the hash of the block containing it.
+    bool ReadTx(const CDiskTxPos& postx, uint256& block_hash, CTransactionRef& tx) const;
+
 protected:
+    interfaces::Chain::NotifyOptions CustomOptions() override;
+
+    bool CustomInit(const std::optional<interfaces::BlockRef>& block) override;
+
     bool CustomAppend(const interfaces::BlockInfo& block) override;
 
+    bool CustomRemove(const interfaces::BlockInfo& block) override;
+
     BaseIndex::DB& GetDB() const override;
 
 public:
@@ -0,0 +1,98 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/txospenderindex.h>
+
+#include <common/args.h>
+#include <dbwrapper.h>
+#include <interfaces/chain.h>
+#include <primitives/block.h>
+#include <util/fs.h>
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+/**
+ * Keys of the index have the type [DB_TXOSPENDER, COutPoint] and map to the
+ * TxoSpender: the spending txid and the height of its block. Only spends in the active chain
+ * are stored; a spend being reorganized out erases its entry again.
+ */
+constexpr uint8_t DB_TXOSPENDER{'s'};
+
+std::unique_ptr<TxoSpenderIndex> g_txospender_index;
+
+/** Access to the spent output index database (indexes/txospenderindex/) */
+class TxoSpenderIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+TxoSpenderIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "txospenderindex", n_cache_size, f_memory, f_wipe)
+{}
+
+TxoSpenderIndex::TxoSpenderIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "txospenderindex"), m_db(std::make_unique<TxoSpenderIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+TxoSpenderIndex::~TxoSpenderIndex() = default;
+
+interfaces::Chain::NotifyOptions TxoSpenderIndex::CustomOptions()
+{
+    interfaces::Chain::NotifyOptions options;
+    options.disconnect_data = true;
+    return options;
+}
+
+bool TxoSpenderIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    assert(block.data);
+    CDBBatch batch(*m_db);
+    for (const CTransactionRef& tx : block.data->vtx) {
+        if (tx->IsCoinBase()) continue;
+        for (const CTxIn& txin : tx->vin) {
+            batch.Write(std::make_pair(DB_TXOSPENDER, txin.prevout), TxoSpender{tx->GetHash(), block.height});
+        }
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool TxoSpenderIndex::CustomRemove(const interfaces::BlockInfo& block)
+{
+    assert(block.data);
+    CDBBatch batch(*m_db);
+    for (const CTransactionRef& tx : block.data->vtx) {
+        if (tx->IsCoinBase()) continue;
+        for (const CTxIn& txin : tx->vin) {
+            batch.Erase(std::make_pair(DB_TXOSPENDER, txin.prevout));
+        }
+    }
+    return m_db->WriteBatch(batch);
+}
+
+BaseIndex::DB& TxoSpenderIndex::GetDB() const { return *m_db; }
+
+std::optional<TxoSpender> TxoSpenderIndex::FindSpender(const COutPoint& prevout) const
+{
+    TxoSpender spender;
+    if (!m_db->Read(std::make_pair(DB_TXOSPENDER, prevout), spender)) return std::nullopt;
+    return spender;
+}
+
+std::vector<std::optional<TxoSpender>> TxoSpenderIndex::FindSpenders(std::span<const COutPoint> prevouts) const
+{
+    // Read in key order, so outputs of the same transaction are looked up together
+    // and neighbouring lookups hit the same database blocks.
+    std::vector<size_t> order(prevouts.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return prevouts[a] < prevouts[b]; });
+
+    std::vector<std::optional<TxoSpender>> ret(prevouts.size());
+    for (size_t i : order) {
+        ret[i] = FindSpender(prevouts[i]);
+    }
+    return ret;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_TXOSPENDERINDEX_H
+#define BITCOIN_INDEX_TXOSPENDERINDEX_H
+
+#include <index/base.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+static constexpr bool DEFAULT_TXOSPENDERINDEX{false};
+
+/** The confirmed transaction spending an output. */
+struct TxoSpender {
+    Txid txid;
+    //! Height of the block containing the spending transaction.
+    int height{0};
+
+    SERIALIZE_METHODS(TxoSpender, obj) { READWRITE(obj.txid, obj.height); }
+};
+
+/**
+ * TxoSpenderIndex records, for every output spent in the active chain, the
+ * transaction spending it. Entries of disconnected blocks are erased, so the
+ * index only ever describes the chain ending in its best block. Callers that
+ * need the hash of the spending block take it from the active chain, if the
+ * height is not above where it forks from that best block.
+ */
+class TxoSpenderIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    bool AllowPrune() const override { return true; }
+
+protected:
+    interfaces::Chain::NotifyOptions CustomOptions() override;
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRemove(const interfaces::BlockInfo& block) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit TxoSpenderIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~TxoSpenderIndex() override;
+
+    /// Look up the confirmed spender of an output. Returns std::nullopt if the
+    /// output is unspent in the active chain (or was never created).
+    std::optional<TxoSpender> FindSpender(const COutPoint& prevout) const;
+
+    /// Look up the confirmed spenders of several outputs at once. The result
+    /// has one element per prevout, in the same order.
+    std::vector<std::optional<TxoSpender>> FindSpenders(std::span<const COutPoint> prevouts) const;
+};
+
+/// The global spent output index. May be null.
+extern std::unique_ptr<TxoSpenderIndex> g_txospender_index;
+
+#endif // BITCOIN_INDEX_TXOSPENDERINDEX_H
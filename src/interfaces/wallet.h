@@ -99,6 +99,9 @@ public:
     // Get a new address.
     virtual util::Result<CTxDestination> getNewDestination(const OutputType type, const std::string& label) = 0;
 
+    //! Get several new addresses at once.
+    virtual util::Result<std::vector<CTxDestination>> getNewDestinations(const OutputType type, const std::string& label, size_t count) = 0;
+
     //! Get public key.
     virtual bool getPubKey(const CScript& script, const CKeyID& address, CPubKey& pub_key) = 0;
 
@@ -17,21 +17,34 @@
 #include <streams.h>
 #include <sync.h>
 #include <tinyformat.h>
+#include <txdb.h>
 #include <uint256.h>
 #include <util/check.h>
 #include <util/overflow.h>
+#include <util/threadnames.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <exception>
 #include <iosfwd>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace kernel {
 
+//! Number of txid ranges the UTXO set is split into when hashing it in parallel
+static constexpr unsigned int UTXO_STATS_SHARDS{16};
+//! Maximum number of additional threads hashing the UTXO set
+static constexpr int MAX_UTXO_STATS_THREADS{7};
+
 CCoinsStats::CCoinsStats(int block_height, const uint256& block_hash)
     : nHeight(block_height),
       hashBlock(block_hash) {}
@@ -111,20 +124,20 @@ static void ApplyStats(CCoinsStats& stats, const uint256& hash, const std::map<u
     }
 }
 
-//! Calculate statistics about the unspent transaction output set
+//! Apply the coins read from a cursor to the stats and hash, stopping at the
+//! first txid whose first byte is end_byte or larger, or when abort is set.
 template <typename T>
-static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point)
+static bool ApplyCoins(CCoinsViewCursor& cursor, CCoinsStats& stats, T& hash_obj, unsigned int end_byte, const std::atomic<bool>& abort, const std::function<void()>* interruption_point)
 {
-    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
-    assert(pcursor);
-
     Txid prevkey;
     std::map<uint32_t, Coin> outputs;
-    while (pcursor->Valid()) {
-        if (interruption_point) interruption_point();
+    while (cursor.Valid()) {
+        if (interruption_point && *interruption_point) (*interruption_point)();
+        if (abort) return false;
         COutPoint key;
         Coin coin;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
+        if (cursor.GetKey(key) && cursor.GetValue(coin)) {
+            if (*UCharCast(key.hash.begin()) >= end_byte) break;
             if (!outputs.empty() && key.hash != prevkey) {
                 ApplyStats(stats, prevkey, outputs);
                 ApplyHash(hash_obj, prevkey, outputs);
@@ -137,12 +150,120 @@ static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, c
             LogError("%s: unable to read value\n", __func__);
             return false;
         }
-        pcursor->Next();
+        cursor.Next();
     }
     if (!outputs.empty()) {
         ApplyStats(stats, prevkey, outputs);
         ApplyHash(hash_obj, prevkey, outputs);
     }
+    return true;
+}
+
+static void CombineHash(MuHash3072& muhash, const MuHash3072& shard_muhash) { muhash *= shard_muhash; }
+static void CombineHash(std::nullptr_t, std::nullptr_t) {}
+
+static void CombineStats(CCoinsStats& stats, const CCoinsStats& shard_stats)
+{
+    stats.nTransactions += shard_stats.nTransactions;
+    stats.nTransactionOutputs += shard_stats.nTransactionOutputs;
+    stats.nBogoSize += shard_stats.nBogoSize;
+    stats.coins_count += shard_stats.coins_count;
+    if (stats.total_amount.has_value()) {
+        stats.total_amount = shard_stats.total_amount.has_value() ? CheckedAdd(*stats.total_amount, *shard_stats.total_amount) : std::nullopt;
+    }
+}
+
+/**
+ * Apply the coins of a set of cursors, one per txid range, to the stats and
+ * hash. The ranges are processed concurrently and combined afterwards, which
+ * is only possible for hashes that do not depend on the order of the coins.
+ * Only the calling thread runs the interruption point.
+ */
+template <typename T>
+static bool ApplyCoinsParallel(std::vector<std::unique_ptr<CCoinsViewCursor>>& cursors, CCoinsStats& stats, T& hash_obj, const std::function<void()>& interruption_point)
+{
+    const unsigned int n_shards = cursors.size();
+    std::vector<CCoinsStats> shard_stats(n_shards);
+    std::vector<T> shard_hashes(n_shards);
+    std::atomic<unsigned int> next_shard{0};
+    std::atomic<bool> failed{false};
+    const auto apply{[&](const std::function<void()>* interruption) {
+        for (unsigned int shard; (shard = next_shard++) < n_shards;) {
+            const unsigned int end_byte{(shard + 1) * 256 / n_shards};
+            if (!ApplyCoins(*cursors[shard], shard_stats[shard], shard_hashes[shard], end_byte, failed, interruption)) {
+                failed = true;
+                return;
+            }
+        }
+    }};
+
+    std::vector<std::thread> threads;
+    const int n_threads{std::clamp(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0, MAX_UTXO_STATS_THREADS)};
+    // Errors of the worker threads are rethrown on the calling thread.
+    std::vector<std::exception_ptr> errors(n_threads);
+    for (int i = 0; i < n_threads; ++i) {
+        threads.emplace_back([&, i] {
+            util::ThreadRename(strprintf("coinstats.%i", i));
+            try {
+                apply(nullptr);
+            } catch (...) {
+                errors[i] = std::current_exception();
+                failed = true;
+            }
+        });
+    }
+    try {
+        apply(&interruption_point);
+    } catch (...) {
+        failed = true;
+        for (auto& thread : threads) thread.join();
+        throw;
+    }
+    for (auto& thread : threads) thread.join();
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+    if (failed) return false;
+
+    for (unsigned int shard = 0; shard < n_shards; ++shard) {
+        CombineStats(stats, shard_stats[shard]);
+        CombineHash(hash_obj, shard_hashes[shard]);
+    }
+    return true;
+}
+
+//! Calculate statistics about the unspent transaction output set
+template <typename T>
+static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point)
+{
+    // The coins database can be read through several cursors at once, so the
+    // work is split into txid ranges when the hash is order independent.
+    const auto* coins_db{dynamic_cast<const CCoinsViewDB*>(view)};
+    if constexpr (!std::is_same_v<T, HashWriter>) {
+        if (coins_db) {
+            std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+            {
+                // The database is only written to under cs_main, so holding it
+                // ensures all cursors read the same state of the UTXO set.
+                LOCK(::cs_main);
+                for (unsigned int shard = 0; shard < UTXO_STATS_SHARDS; ++shard) {
+                    uint256 start;
+                    *start.begin() = shard * 256 / UTXO_STATS_SHARDS;
+                    cursors.push_back(coins_db->Cursor(COutPoint{Txid::FromUint256(start), 0}));
+                }
+            }
+            if (!ApplyCoinsParallel(cursors, stats, hash_obj, interruption_point)) return false;
+            FinalizeHash(hash_obj, stats);
+            stats.nDiskSize = view->EstimateSize();
+            return true;
+        }
+    }
+
+    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
+    assert(pcursor);
+
+    const std::atomic<bool> abort{false};
+    if (!ApplyCoins(*pcursor, stats, hash_obj, /*end_byte=*/256, abort, &interruption_point)) return false;
 
     FinalizeHash(hash_obj, stats);
 
@@ -285,6 +285,9 @@ struct Peer {
     /** Timestamp after which we will send the next BIP133 `feefilter` message
       * to the peer. */
     std::chrono::microseconds m_next_send_feefilter GUARDED_BY(NetEventsInterface::g_msgproc_mutex){0};
+    /** When we will next request a reconciliation sketch from this peer, if
+      * we are its txreconciliation initiator. */
+    std::chrono::microseconds m_next_recon_request GUARDED_BY(NetEventsInterface::g_msgproc_mutex){0};
 
     struct TxRelay {
         mutable RecursiveMutex m_bloom_filter_mutex;
@@ -650,7 +653,7 @@ private:
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_headers_presync_mutex, g_msgproc_mutex);
     /** Various helpers for headers processing, invoked by ProcessHeadersMessage() */
     /** Return true if headers are continuous and have valid proof-of-work (DoS points assigned on failure) */
-    bool CheckHeadersPoW(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams, Peer& peer);
+    bool CheckHeadersPoW(const std::vector<CBlockHeader>& headers, Peer& peer);
     /** Calculate an anti-DoS work threshold for headers chains */
     arith_uint256 GetAntiDoSWorkThreshold();
     /** Deal with state tracking and headers sync for peers that send
@@ -954,6 +957,9 @@ private:
         EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, peer.m_getdata_requests_mutex, NetEventsInterface::g_msgproc_mutex)
         LOCKS_EXCLUDED(::cs_main);
 
+    /** Announce transactions resulting from a reconciliation round to the peer. */
+    void AnnounceReconciledTxs(CNode& node, std::span<const Wtxid> wtxids);
+
     /** Process a new block. Perform any post-processing housekeeping */
     void ProcessBlock(CNode& node, const std::shared_ptr<const CBlock>& block, bool force_processing, bool min_pow_checked);
 
@@ -979,8 +985,8 @@ private:
 
     /** Orphan/conflicted/etc transactions that are kept for compact block reconstruction.
      *  The last -blockreconstructionextratxn/DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN of
-     *  these are kept in a ring buffer */
-    std::vector<CTransactionRef> vExtraTxnForCompact GUARDED_BY(g_msgproc_mutex);
+     *  these are kept in a ring buffer, alongside their wtxids */
+    std::vector<std::pair<Wtxid, CTransactionRef>> vExtraTxnForCompact GUARDED_BY(g_msgproc_mutex);
     /** Offset into vExtraTxnForCompact to insert the next tx */
     size_t vExtraTxnForCompactIt GUARDED_BY(g_msgproc_mutex) = 0;
 
@@ -1774,7 +1780,7 @@ void PeerManagerImpl::AddToCompactExtraTransactions(const CTransactionRef& tx)
         return;
     if (!vExtraTxnForCompact.size())
         vExtraTxnForCompact.resize(m_opts.max_extra_txs);
-    vExtraTxnForCompact[vExtraTxnForCompactIt] = tx;
+    vExtraTxnForCompact[vExtraTxnForCompactIt] = std::make_pair(tx->GetWitnessHash(), tx);
     vExtraTxnForCompactIt = (vExtraTxnForCompactIt + 1) % m_opts.max_extra_txs;
 }
 
@@ -2415,6 +2421,21 @@ CTransactionRef PeerManagerImpl::FindTxForGetData(const Peer::TxRelay& tx_relay,
     return {};
 }
 
+void PeerManagerImpl::AnnounceReconciledTxs(CNode& node, std::span<const Wtxid> wtxids)
+{
+    std::vector<CInv> invs;
+    for (const Wtxid& wtxid : wtxids) {
+        // Not in the mempool anymore? don't bother announcing it.
+        if (!m_mempool.exists(wtxid)) continue;
+        invs.emplace_back(MSG_WTX, wtxid.ToUint256());
+        if (invs.size() == MAX_INV_SZ) {
+            MakeAndPushMessage(node, NetMsgType::INV, invs);
+            invs.clear();
+        }
+    }
+    if (!invs.empty()) MakeAndPushMessage(node, NetMsgType::INV, invs);
+}
+
 void PeerManagerImpl::ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic<bool>& interruptMsgProc)
 {
     AssertLockNotHeld(cs_main);
@@ -2512,10 +2533,10 @@ void PeerManagerImpl::SendBlockTransactions(CNode& pfrom, Peer& peer, const CBlo
     MakeAndPushMessage(pfrom, NetMsgType::BLOCKTXN, resp);
 }
 
-bool PeerManagerImpl::CheckHeadersPoW(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams, Peer& peer)
+bool PeerManagerImpl::CheckHeadersPoW(const std::vector<CBlockHeader>& headers, Peer& peer)
 {
     // Do these headers have proof-of-work matching what's claimed?
-    if (!HasValidProofOfWork(headers, consensusParams)) {
+    if (!m_chainman.CheckHeadersProofOfWork(headers)) {
         Misbehaving(peer, "header with invalid proof of work");
         return false;
     }
@@ -2880,7 +2901,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     // We'll rely on headers having valid proof-of-work further down, as an
     // anti-DoS criteria (note: this check is required before passing any
     // headers into HeadersSyncState).
-    if (!CheckHeadersPoW(headers, m_chainparams.GetConsensus(), peer)) {
+    if (!CheckHeadersPoW(headers, peer)) {
         // Misbehaving() calls are handled within CheckHeadersPoW(), so we can
         // just return. (Note that even if a header is announced via compact
         // block, the header itself should be valid, so this type of error can
@@ -3853,6 +3874,67 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    if (msg_type == NetMsgType::REQRECON) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogDebug(BCLog::NET, "reqrecon from peer=%d ignored, as we do not reconcile transactions with it\n", pfrom.GetId());
+            return;
+        }
+
+        uint16_t remote_set_size, remote_q;
+        vRecv >> remote_set_size >> remote_q;
+
+        const auto sketch{m_txreconciliation->HandleReconciliationRequest(pfrom.GetId(), remote_set_size, remote_q)};
+        if (!sketch) {
+            LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected reqrecon), %s\n", pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+            return;
+        }
+        MakeAndPushMessage(pfrom, NetMsgType::SKETCH, *sketch);
+        return;
+    }
+
+    if (msg_type == NetMsgType::SKETCH) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogDebug(BCLog::NET, "sketch from peer=%d ignored, as we do not reconcile transactions with it\n", pfrom.GetId());
+            return;
+        }
+
+        std::vector<uint8_t> remote_sketch;
+        vRecv >> remote_sketch;
+
+        const auto result{m_txreconciliation->ReconcileWithSketch(pfrom.GetId(), remote_sketch)};
+        if (!result) {
+            LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected or malformed sketch), %s\n", pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+            return;
+        }
+        // Tell the peer which of its transactions we are missing (or that decoding failed, in
+        // which case it floods its set), then announce the ones it is missing.
+        MakeAndPushMessage(pfrom, NetMsgType::RECONCILDIFF, result->success, result->request);
+        AnnounceReconciledTxs(pfrom, result->announce);
+        return;
+    }
+
+    if (msg_type == NetMsgType::RECONCILDIFF) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogDebug(BCLog::NET, "reconcildiff from peer=%d ignored, as we do not reconcile transactions with it\n", pfrom.GetId());
+            return;
+        }
+
+        bool success;
+        std::vector<uint32_t> ask_short_ids;
+        vRecv >> success >> ask_short_ids;
+
+        const auto announce{m_txreconciliation->HandleReconciliationDifference(pfrom.GetId(), success, ask_short_ids)};
+        if (!announce) {
+            LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected reconcildiff), %s\n", pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+            return;
+        }
+        AnnounceReconciledTxs(pfrom, *announce);
+        return;
+    }
+
     if (msg_type == NetMsgType::ADDR || msg_type == NetMsgType::ADDRV2) {
         const auto ser_params{
             msg_type == NetMsgType::ADDRV2 ?
@@ -3965,6 +4047,9 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
 
         const auto current_time{GetTime<std::chrono::microseconds>()};
         uint256* best_block{nullptr};
+        // Transaction announcements are handed to the TxDownloadManager in one batch.
+        std::vector<GenTxid> tx_gtxids;
+        std::vector<const CInv*> tx_invs;
 
         for (CInv& inv : vInv) {
             if (interruptMsgProc) return;
@@ -3998,18 +4083,25 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                     pfrom.fDisconnect = true;
                     return;
                 }
-                const GenTxid gtxid = ToGenTxid(inv);
                 AddKnownTx(*peer, inv.hash);
-
-                if (!m_chainman.IsInitialBlockDownload()) {
-                    const bool fAlreadyHave{m_txdownloadman.AddTxAnnouncement(pfrom.GetId(), gtxid, current_time)};
-                    LogDebug(BCLog::NET, "got inv: %s  %s peer=%d\n", inv.ToString(), fAlreadyHave ? "have" : "new", pfrom.GetId());
+                if (m_txreconciliation && inv.IsMsgWtx()) {
+                    // The peer has the transaction, so there's no need to reconcile it.
+                    m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), Wtxid::FromUint256(inv.hash));
                 }
+                tx_gtxids.push_back(ToGenTxid(inv));
+                tx_invs.push_back(&inv);
             } else {
                 LogDebug(BCLog::NET, "Unknown inv type \"%s\" received from peer=%d\n", inv.ToString(), pfrom.GetId());
             }
         }
 
+        if (!tx_gtxids.empty() && !m_chainman.IsInitialBlockDownload()) {
+            const std::vector<bool> already_have{m_txdownloadman.AddTxAnnouncements(pfrom.GetId(), tx_gtxids, current_time)};
+            for (size_t i = 0; i < tx_invs.size(); ++i) {
+                LogDebug(BCLog::NET, "got inv: %s  %s peer=%d\n", tx_invs[i]->ToString(), already_have[i] ? "have" : "new", pfrom.GetId());
+            }
+        }
+
         if (best_block != nullptr) {
             // If we haven't started initial headers-sync with this peer, then
             // consider sending a getheaders now. On initial startup, there's a
@@ -5794,6 +5886,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     // No reason to drain out at many times the network's capacity,
                     // especially since we have many peers and some will draw much shorter delays.
                     unsigned int nRelayedTransactions = 0;
+                    const bool reconcile_txs{m_txreconciliation && m_txreconciliation->IsPeerRegistered(pto->GetId())};
                     LOCK(tx_relay->m_bloom_filter_mutex);
                     size_t broadcast_max{INVENTORY_BROADCAST_TARGET + (tx_relay->m_tx_inventory_to_send.size()/1000)*5};
                     broadcast_max = std::min<size_t>(INVENTORY_BROADCAST_MAX, broadcast_max);
@@ -5825,14 +5918,17 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                             continue;
                         }
                         if (tx_relay->m_bloom_filter && !tx_relay->m_bloom_filter->IsRelevantAndUpdate(*txinfo.tx)) continue;
+                        nRelayedTransactions++;
+                        tx_relay->m_tx_inventory_known_filter.insert(inv.hash);
+                        // Leave it to the next reconciliation round if we can, and fall
+                        // back to flooding if the peer's reconciliation set is full.
+                        if (reconcile_txs && m_txreconciliation->AddToSet(pto->GetId(), wtxid)) continue;
                         // Send
                         vInv.push_back(inv);
-                        nRelayedTransactions++;
                         if (vInv.size() == MAX_INV_SZ) {
                             MakeAndPushMessage(*pto, NetMsgType::INV, vInv);
                             vInv.clear();
                         }
-                        tx_relay->m_tx_inventory_known_filter.insert(inv.hash);
                     }
 
                     // Ensure we'll respond to GETDATA requests for anything we've just announced
@@ -5843,6 +5939,20 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         if (!vInv.empty())
             MakeAndPushMessage(*pto, NetMsgType::INV, vInv);
 
+        //
+        // Message: reqrecon
+        //
+        if (m_txreconciliation && !pto->IsInboundConn() && peer->m_next_recon_request < current_time &&
+            m_txreconciliation->IsPeerRegistered(pto->GetId())) {
+            // The first round starts one interval after the connection is up.
+            if (peer->m_next_recon_request != 0s) {
+                if (const auto request{m_txreconciliation->InitiateReconciliationRequest(pto->GetId())}) {
+                    MakeAndPushMessage(*pto, NetMsgType::REQRECON, request->first, request->second);
+                }
+            }
+            peer->m_next_recon_request = current_time + RECON_REQUEST_INTERVAL;
+        }
+
         // Detect whether we're stalling
         auto stalling_timeout = m_block_stalling_timeout.load();
         if (state.m_stalling_since.count() && state.m_stalling_since < current_time - stalling_timeout) {
@@ -11,6 +11,8 @@
 
 #include <cstdint>
 #include <memory>
+#include <span>
+#include <vector>
 
 class CBlock;
 class CRollingBloomFilter;
@@ -36,6 +38,8 @@ static constexpr auto NONPREF_PEER_TX_DELAY{2s};
 static constexpr auto OVERLOADED_PEER_TX_DELAY{2s};
 /** How long to wait before downloading a transaction from an additional peer */
 static constexpr auto GETDATA_TX_INTERVAL{60s};
+/** Maximum number of announcements of an inv message looked up under one mempool lock acquisition */
+static constexpr size_t MAX_ANNOUNCEMENTS_PER_MEMPOOL_LOCK{1000};
 struct TxDownloadOptions {
     /** Read-only reference to mempool. */
     const CTxMemPool& m_mempool;
@@ -137,6 +141,12 @@ public:
      * Returns true if this was a dropped inv (p2p_inv=true and we already have the tx), false otherwise. */
     bool AddTxAnnouncement(NodeId peer, const GenTxid& gtxid, std::chrono::microseconds now);
 
+    /** Consider adding all tx hashes of an inv message to txrequest, in order. Equivalent to calling
+     * AddTxAnnouncement for each of them, but looks up the mempool under one lock acquisition per
+     * MAX_ANNOUNCEMENTS_PER_MEMPOOL_LOCK announcements.
+     * Returns, for each announcement, whether it was a dropped inv. */
+    std::vector<bool> AddTxAnnouncements(NodeId peer, std::span<const GenTxid> gtxids, std::chrono::microseconds now);
+
     /** Get getdata requests to send. */
     std::vector<GenTxid> GetRequestsToSend(NodeId nodeid, std::chrono::microseconds current_time);
 
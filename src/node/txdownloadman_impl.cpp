@@ -43,6 +43,10 @@ bool TxDownloadManager::AddTxAnnouncement(NodeId peer, const GenTxid& gtxid, std
 {
     return m_impl->AddTxAnnouncement(peer, gtxid, now);
 }
+std::vector<bool> TxDownloadManager::AddTxAnnouncements(NodeId peer, std::span<const GenTxid> gtxids, std::chrono::microseconds now)
+{
+    return m_impl->AddTxAnnouncements(peer, gtxids, now);
+}
 std::vector<GenTxid> TxDownloadManager::GetRequestsToSend(NodeId nodeid, std::chrono::microseconds current_time)
 {
     return m_impl->GetRequestsToSend(nodeid, current_time);
@@ -224,6 +228,23 @@ bool TxDownloadManagerImpl::AddTxAnnouncement(NodeId peer, const GenTxid& gtxid,
     return false;
 }
 
+std::vector<bool> TxDownloadManagerImpl::AddTxAnnouncements(NodeId peer, std::span<const GenTxid> gtxids, std::chrono::microseconds now)
+{
+    std::vector<bool> already_have;
+    already_have.reserve(gtxids.size());
+
+    // Every AlreadyHaveTx() call looks up the mempool. Take its lock once per chunk of
+    // announcements instead of once per announcement, but don't hold it across a whole inv
+    // message, which may have up to 50000 entries.
+    for (size_t start{0}; start < gtxids.size(); start += MAX_ANNOUNCEMENTS_PER_MEMPOOL_LOCK) {
+        LOCK(m_opts.m_mempool.cs);
+        for (const GenTxid& gtxid : gtxids.subspan(start, std::min(MAX_ANNOUNCEMENTS_PER_MEMPOOL_LOCK, gtxids.size() - start))) {
+            already_have.push_back(AddTxAnnouncement(peer, gtxid, now));
+        }
+    }
+    return already_have;
+}
+
 bool TxDownloadManagerImpl::MaybeAddOrphanResolutionCandidate(const std::vector<Txid>& unique_parents, const Wtxid& wtxid, NodeId nodeid, std::chrono::microseconds now)
 {
     auto it_peer = m_peer_info.find(nodeid);
@@ -5,9 +5,13 @@
 #include <node/txreconciliation.h>
 
 #include <common/system.h>
+#include <crypto/siphash.h>
 #include <logging.h>
+#include <node/minisketchwrapper.h>
 #include <util/check.h>
 
+#include <algorithm>
+#include <cmath>
 #include <unordered_map>
 #include <variant>
 
@@ -36,9 +40,6 @@ class TxReconciliationState
 {
 public:
     /**
-     * TODO: This field is public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * Reconciliation protocol assumes using one role consistently: either a reconciliation
      * initiator (requesting sketches), or responder (sending sketches). This defines our role,
      * based on the direction of the p2p connection.
@@ -47,14 +48,53 @@ public:
     bool m_we_initiate;
 
     /**
-     * TODO: These fields are public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * These values are used to salt short IDs, which is necessary for transaction reconciliations.
      */
     uint64_t m_k0, m_k1;
 
+    /**
+     * Transactions we want to announce to the peer, keyed by their short ID. Since short IDs are
+     * salted per peer, they are computed once here when a transaction is added to the set
+     * rather than every time a sketch is built.
+     */
+    std::unordered_map<uint32_t, Wtxid> m_local_set;
+
+    /**
+     * Sketch of m_local_set computed for the last sketch request or reconciliation. Reset
+     * whenever m_local_set changes.
+     */
+    std::optional<Minisketch> m_cached_sketch;
+
+    /** As the initiator, whether we sent a reconciliation request and wait for the sketch. */
+    bool m_request_pending{false};
+
+    /**
+     * As the responder, the set we sent a sketch of, kept until the initiator tells us which of
+     * its transactions it is missing. Transactions arriving in the meantime go to m_local_set
+     * and are reconciled in the next round.
+     */
+    std::optional<std::unordered_map<uint32_t, Wtxid>> m_sketched_set;
+
     TxReconciliationState(bool we_initiate, uint64_t k0, uint64_t k1) : m_we_initiate(we_initiate), m_k0(k0), m_k1(k1) {}
+
+    /** Compute the BIP-330 short ID of a transaction, which is never zero. */
+    uint32_t ComputeShortID(const Wtxid& wtxid) const
+    {
+        const uint64_t s{SipHashUint256(m_k0, m_k1, wtxid.ToUint256())};
+        return 1 + (s % 0xFFFFFFFF);
+    }
+
+    /** Return a sketch of m_local_set with the given capacity, reusing the cached one if possible. */
+    const Minisketch& GetLocalSketch(uint32_t capacity)
+    {
+        if (!m_cached_sketch || m_cached_sketch->GetCapacity() != capacity) {
+            m_cached_sketch = node::MakeMinisketch32(capacity);
+            for (const auto& [short_id, wtxid] : m_local_set) {
+                m_cached_sketch->Add(short_id);
+            }
+        }
+        return *m_cached_sketch;
+    }
 };
 
 } // namespace
@@ -77,7 +117,12 @@ private:
     std::unordered_map<NodeId, std::variant<uint64_t, TxReconciliationState>> m_states GUARDED_BY(m_txreconciliation_mutex);
 
 public:
-    explicit Impl(uint32_t recon_version) : m_recon_version(recon_version) {}
+    explicit Impl(uint32_t recon_version) : m_recon_version(recon_version)
+    {
+        // Select the fastest Minisketch implementation now, rather than when computing the
+        // first sketch.
+        (void)node::MakeMinisketch32(1);
+    }
 
     uint64_t PreRegisterPeer(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
     {
@@ -142,6 +187,169 @@ public:
         return (recon_state != m_states.end() &&
                 std::holds_alternative<TxReconciliationState>(recon_state->second));
     }
+
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state = GetRegisteredPeerState(peer_id);
+        if (!peer_state) return false;
+
+        if (peer_state->m_local_set.size() >= MAX_RECONSET_SIZE) {
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation set of peer=%d is full, not adding %s\n",
+                          peer_id, wtxid.ToString());
+            return false;
+        }
+
+        // A short ID collision is handled like a full set: the colliding transaction can't
+        // be reconciled, so it has to be flooded.
+        if (!peer_state->m_local_set.try_emplace(peer_state->ComputeShortID(wtxid), wtxid).second) return false;
+        peer_state->m_cached_sketch.reset();
+        return true;
+    }
+
+    bool TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state = GetRegisteredPeerState(peer_id);
+        if (!peer_state) return false;
+
+        const auto it{peer_state->m_local_set.find(peer_state->ComputeShortID(wtxid))};
+        if (it == peer_state->m_local_set.end() || it->second != wtxid) return false;
+        peer_state->m_local_set.erase(it);
+        peer_state->m_cached_sketch.reset();
+        return true;
+    }
+
+    size_t GetSetSize(NodeId peer_id) const EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        const auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return 0;
+        const auto* peer_state = std::get_if<TxReconciliationState>(&recon_state->second);
+        return peer_state ? peer_state->m_local_set.size() : 0;
+    }
+
+    std::vector<uint8_t> GetSketch(NodeId peer_id, uint32_t capacity) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state = GetRegisteredPeerState(peer_id);
+        if (!peer_state || capacity == 0 || capacity > MAX_SKETCH_CAPACITY) return {};
+        return peer_state->GetLocalSketch(capacity).Serialize();
+    }
+
+    std::optional<std::pair<uint16_t, uint16_t>> InitiateReconciliationRequest(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state = GetRegisteredPeerState(peer_id);
+        if (!peer_state || !peer_state->m_we_initiate || peer_state->m_request_pending) return std::nullopt;
+
+        peer_state->m_request_pending = true;
+        return std::make_pair(static_cast<uint16_t>(peer_state->m_local_set.size()),
+                              static_cast<uint16_t>(RECON_Q * Q_PRECISION));
+    }
+
+    std::optional<std::vector<uint8_t>> HandleReconciliationRequest(NodeId peer_id, uint16_t remote_set_size, uint16_t remote_q) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state = GetRegisteredPeerState(peer_id);
+        if (!peer_state || peer_state->m_we_initiate || peer_state->m_sketched_set) return std::nullopt;
+
+        const double q{double(remote_q) / Q_PRECISION};
+        const uint32_t capacity{TxReconciliationTracker::EstimateSketchCapacity(peer_state->m_local_set.size(), remote_set_size, q)};
+        std::vector<uint8_t> sketch{peer_state->GetLocalSketch(capacity).Serialize()};
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation request from peer=%d: set size=%d, remote set size=%d, capacity=%d\n",
+                      peer_id, peer_state->m_local_set.size(), remote_set_size, capacity);
+
+        peer_state->m_sketched_set = std::move(peer_state->m_local_set);
+        peer_state->m_local_set.clear();
+        peer_state->m_cached_sketch.reset();
+        return sketch;
+    }
+
+    std::optional<std::vector<Wtxid>> HandleReconciliationDifference(NodeId peer_id, bool success, std::span<const uint32_t> ask_short_ids) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state = GetRegisteredPeerState(peer_id);
+        if (!peer_state || !peer_state->m_sketched_set) return std::nullopt;
+
+        std::vector<Wtxid> announce;
+        if (success) {
+            announce.reserve(ask_short_ids.size());
+            for (const uint32_t short_id : ask_short_ids) {
+                const auto it{peer_state->m_sketched_set->find(short_id)};
+                if (it != peer_state->m_sketched_set->end()) announce.push_back(it->second);
+            }
+        } else {
+            announce.reserve(peer_state->m_sketched_set->size());
+            for (const auto& [short_id, wtxid] : *peer_state->m_sketched_set) {
+                announce.push_back(wtxid);
+            }
+        }
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d %s: sketched set size=%d, announce=%d\n",
+                      peer_id, success ? "succeeded" : "failed", peer_state->m_sketched_set->size(), announce.size());
+
+        peer_state->m_sketched_set.reset();
+        return announce;
+    }
+
+    std::optional<ReconciliationResult> ReconcileWithSketch(NodeId peer_id, std::span<const uint8_t> remote_sketch) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state = GetRegisteredPeerState(peer_id);
+        if (!peer_state || !peer_state->m_request_pending) return std::nullopt;
+
+        // Each element of a sketch over 32-bit short IDs takes 4 bytes.
+        if (remote_sketch.empty() || remote_sketch.size() % 4 != 0) return std::nullopt;
+        const size_t capacity{remote_sketch.size() / 4};
+        if (capacity > MAX_SKETCH_CAPACITY) return std::nullopt;
+
+        Minisketch sketch{node::MakeMinisketch32(capacity)};
+        sketch.Deserialize(remote_sketch);
+        sketch.Merge(peer_state->GetLocalSketch(capacity));
+
+        ReconciliationResult result;
+        if (const auto differences{sketch.Decode(capacity)}) {
+            result.success = true;
+            for (const uint64_t short_id : *differences) {
+                const auto it{peer_state->m_local_set.find(short_id)};
+                if (it != peer_state->m_local_set.end()) {
+                    result.announce.push_back(it->second);
+                } else {
+                    result.request.push_back(short_id);
+                }
+            }
+        } else {
+            result.announce.reserve(peer_state->m_local_set.size());
+            for (const auto& [short_id, wtxid] : peer_state->m_local_set) {
+                result.announce.push_back(wtxid);
+            }
+        }
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d %s: set size=%d, capacity=%d, announce=%d, request=%d\n",
+                      peer_id, result.success ? "succeeded" : "failed", peer_state->m_local_set.size(), capacity,
+                      result.announce.size(), result.request.size());
+
+        peer_state->m_local_set.clear();
+        peer_state->m_cached_sketch.reset();
+        peer_state->m_request_pending = false;
+        return result;
+    }
+
+private:
+    TxReconciliationState* GetRegisteredPeerState(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        AssertLockHeld(m_txreconciliation_mutex);
+        const auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&recon_state->second);
+    }
 };
 
 TxReconciliationTracker::TxReconciliationTracker(uint32_t recon_version) : m_impl{std::make_unique<TxReconciliationTracker::Impl>(recon_version)} {}
@@ -168,3 +376,51 @@ bool TxReconciliationTracker::IsPeerRegistered(NodeId peer_id) const
 {
     return m_impl->IsPeerRegistered(peer_id);
 }
+
+bool TxReconciliationTracker::AddToSet(NodeId peer_id, const Wtxid& wtxid)
+{
+    return m_impl->AddToSet(peer_id, wtxid);
+}
+
+bool TxReconciliationTracker::TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid)
+{
+    return m_impl->TryRemovingFromSet(peer_id, wtxid);
+}
+
+size_t TxReconciliationTracker::GetSetSize(NodeId peer_id) const
+{
+    return m_impl->GetSetSize(peer_id);
+}
+
+std::vector<uint8_t> TxReconciliationTracker::GetSketch(NodeId peer_id, uint32_t capacity)
+{
+    return m_impl->GetSketch(peer_id, capacity);
+}
+
+std::optional<std::pair<uint16_t, uint16_t>> TxReconciliationTracker::InitiateReconciliationRequest(NodeId peer_id)
+{
+    return m_impl->InitiateReconciliationRequest(peer_id);
+}
+
+std::optional<std::vector<uint8_t>> TxReconciliationTracker::HandleReconciliationRequest(NodeId peer_id, uint16_t remote_set_size, uint16_t remote_q)
+{
+    return m_impl->HandleReconciliationRequest(peer_id, remote_set_size, remote_q);
+}
+
+std::optional<std::vector<Wtxid>> TxReconciliationTracker::HandleReconciliationDifference(NodeId peer_id, bool success, std::span<const uint32_t> ask_short_ids)
+{
+    return m_impl->HandleReconciliationDifference(peer_id, success, ask_short_ids);
+}
+
+std::optional<ReconciliationResult> TxReconciliationTracker::ReconcileWithSketch(NodeId peer_id, std::span<const uint8_t> remote_sketch)
+{
+    return m_impl->ReconcileWithSketch(peer_id, remote_sketch);
+}
+
+uint32_t TxReconciliationTracker::EstimateSketchCapacity(size_t local_set_size, size_t remote_set_size, double q)
+{
+    const size_t set_size_diff{std::max(local_set_size, remote_set_size) - std::min(local_set_size, remote_set_size)};
+    const size_t min_size{std::min(local_set_size, remote_set_size)};
+    const size_t capacity{set_size_diff + static_cast<size_t>(std::ceil(q * min_size)) + 1};
+    return std::min<size_t>(capacity, MAX_SKETCH_CAPACITY);
+}
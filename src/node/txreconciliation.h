@@ -7,12 +7,32 @@
 
 #include <net.h>
 #include <sync.h>
+#include <util/transaction_identifier.h>
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 /** Supported transaction reconciliation protocol version */
 static constexpr uint32_t TXRECONCILIATION_VERSION{1};
+/** Maximum number of transactions kept in the reconciliation set of a peer. */
+static constexpr size_t MAX_RECONSET_SIZE{3000};
+/**
+ * Limit on the capacity of a sketch we compute or accept, to avoid DoS. A sketch of this
+ * capacity has a serialized size of 16 KiB.
+ */
+static constexpr uint32_t MAX_SKETCH_CAPACITY{2 << 11};
+/** Coefficient used to estimate the set difference from the smaller of the two sets, see BIP-330. */
+static constexpr double RECON_Q{0.25};
+/** Precision with which q is encoded as an integer in reqrecon messages, see BIP-330. */
+static constexpr uint16_t Q_PRECISION{(2 << 14) - 1};
+/** Interval between reconciliation requests we send to each outbound peer. */
+static constexpr std::chrono::seconds RECON_REQUEST_INTERVAL{8};
 
 enum class ReconciliationRegisterResult {
     NOT_FOUND,
@@ -21,6 +41,19 @@ enum class ReconciliationRegisterResult {
     PROTOCOL_VIOLATION,
 };
 
+/** Result of reconciling our set for a peer against a sketch of the peer's set. */
+struct ReconciliationResult {
+    /**
+     * Whether the set difference could be decoded. If not, announce is the whole set we had
+     * for the peer, which should be flooded to them instead.
+     */
+    bool success{false};
+    /** Transactions from our set the peer is missing, to be announced to them. */
+    std::vector<Wtxid> announce;
+    /** Short IDs of transactions the peer has and we are missing, to be requested from them. */
+    std::vector<uint32_t> request;
+};
+
 /**
  * Transaction reconciliation is a way for nodes to efficiently announce transactions.
  * This object keeps track of all txreconciliation-related communications with the peers.
@@ -84,6 +117,69 @@ public:
      * Check if a peer is registered to reconcile transactions with us.
      */
     bool IsPeerRegistered(NodeId peer_id) const;
+
+    /**
+     * Step 1. Add a transaction we want to announce to the peer to its reconciliation set,
+     * instead of announcing it right away. Returns false if the peer is not registered, the
+     * set is full, the transaction is already in the set, or its short ID collides with a
+     * transaction in the set. In those cases the caller should fall back to flooding.
+     */
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid);
+
+    /**
+     * Remove a transaction from the reconciliation set of the peer, e.g. because the peer
+     * announced it to us in the meantime. Returns whether the transaction was removed.
+     */
+    bool TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid);
+
+    /** Number of transactions in the reconciliation set of the peer (0 if not registered). */
+    size_t GetSetSize(NodeId peer_id) const;
+
+    /**
+     * Step 2 (responder). Compute the serialized sketch of our reconciliation set for the peer,
+     * with the capacity the initiator asked for. Short IDs are computed once when transactions
+     * are added to the set, and the sketch is cached until the set changes, so repeated
+     * requests (e.g. an extension round) are served without recomputation. Returns an empty
+     * vector if the peer is not registered or the capacity is out of range.
+     */
+    std::vector<uint8_t> GetSketch(NodeId peer_id, uint32_t capacity);
+
+    /**
+     * Step 2 (initiator). Start a reconciliation round with an outbound peer. Returns the size
+     * of our set for the peer and the encoded q to send in a reqrecon message, or std::nullopt
+     * if we are not the initiator for this peer or are still waiting for its previous sketch.
+     */
+    std::optional<std::pair<uint16_t, uint16_t>> InitiateReconciliationRequest(NodeId peer_id);
+
+    /**
+     * Step 2 (responder). Handle a reqrecon message: compute a sketch of our set for the peer
+     * with a capacity estimated from both set sizes, and keep that set aside until the peer
+     * sends the difference. Returns std::nullopt if the peer is not registered, is not the
+     * initiator, or has not yet finished the previous round.
+     */
+    std::optional<std::vector<uint8_t>> HandleReconciliationRequest(NodeId peer_id, uint16_t remote_set_size, uint16_t remote_q);
+
+    /**
+     * Step 4 (responder). Handle a reconcildiff message. On success, returns the transactions
+     * from the sketched set matching the short IDs the peer asked for; on failure, the whole
+     * sketched set, to be flooded. Returns std::nullopt if we did not send the peer a sketch.
+     */
+    std::optional<std::vector<Wtxid>> HandleReconciliationDifference(NodeId peer_id, bool success, std::span<const uint32_t> ask_short_ids);
+
+    /**
+     * Step 3 (initiator). Combine a serialized sketch of the peer's set with a sketch of our
+     * set for the peer, and decode the difference. Our set for the peer is cleared, as every
+     * transaction in it is either known to the peer or returned to be announced.
+     * Returns std::nullopt if the peer is not registered, we did not request a sketch, or the
+     * peer sent a malformed sketch.
+     */
+    std::optional<ReconciliationResult> ReconcileWithSketch(NodeId peer_id, std::span<const uint8_t> remote_sketch);
+
+    /**
+     * Estimate the sketch capacity needed to reconcile two sets of the given sizes, following
+     * BIP-330: the difference in sizes plus q times the smaller set, plus one.
+     */
+    static uint32_t EstimateSketchCapacity(size_t local_set_size, size_t remote_set_size, double q = RECON_Q);
 };
 
 #endif // BITCOIN_NODE_TXRECONCILIATION_H
@@ -264,6 +264,21 @@ inline constexpr const char* WTXIDRELAY{"wtxidrelay"};
  * txreconciliation, as described by BIP 330.
  */
 inline constexpr const char* SENDTXRCNCL{"sendtxrcncl"};
+/**
+ * Contains the size of the sender's reconciliation set and the coefficient q.
+ * Sent by the txreconciliation initiator to request a sketch, as described by BIP 330.
+ */
+inline constexpr const char* REQRECON{"reqrecon"};
+/**
+ * Contains a sketch of the sender's reconciliation set, in response to a
+ * reqrecon message, as described by BIP 330.
+ */
+inline constexpr const char* SKETCH{"sketch"};
+/**
+ * Contains whether decoding the set difference succeeded and the short txids
+ * the initiator is missing, as described by BIP 330.
+ */
+inline constexpr const char* RECONCILDIFF{"reconcildiff"};
 }; // namespace NetMsgType
 
 /** All known message types (see above). Keep this in the same order as the list of messages above. */
@@ -303,6 +318,9 @@ inline const std::array ALL_NET_MESSAGE_TYPES{std::to_array<std::string>({
     NetMsgType::CFCHECKPT,
     NetMsgType::WTXIDRELAY,
     NetMsgType::SENDTXRCNCL,
+    NetMsgType::REQRECON,
+    NetMsgType::SKETCH,
+    NetMsgType::RECONCILDIFF,
 })};
 
 /** nServices flags */
@@ -4,15 +4,27 @@
 
 #include <psbt.h>
 
+#include <common/system.h>
 #include <common/types.h>
 #include <node/types.h>
 #include <policy/policy.h>
 #include <script/signingprovider.h>
+#include <tinyformat.h>
 #include <util/check.h>
 #include <util/strencodings.h>
+#include <util/threadnames.h>
+
+#include <algorithm>
+#include <exception>
+#include <thread>
 
 using common::PSBTError;
 
+//! Maximum number of threads used by SignPSBTInputs
+static constexpr int MAX_SIGNING_THREADS{8};
+//! Minimum number of inputs SignPSBTInputs gives each thread, so that signing outweighs starting it
+static constexpr size_t MIN_INPUTS_PER_SIGNING_THREAD{16};
+
 PartiallySignedTransaction::PartiallySignedTransaction(const CMutableTransaction& tx) : tx(tx)
 {
     inputs.resize(tx.vin.size());
@@ -298,7 +310,7 @@ bool PSBTInputSigned(const PSBTInput& input)
     return !input.final_script_sig.empty() || !input.final_script_witness.IsNull();
 }
 
-bool PSBTInputSignedAndVerified(const PartiallySignedTransaction psbt, unsigned int input_index, const PrecomputedTransactionData* txdata)
+bool PSBTInputSignedAndVerified(const PartiallySignedTransaction& psbt, unsigned int input_index, const PrecomputedTransactionData* txdata)
 {
     CTxOut utxo;
     assert(psbt.inputs.size() >= input_index);
@@ -487,6 +499,40 @@ PSBTError SignPSBTInput(const SigningProvider& provider, PartiallySignedTransact
     return sig_complete ? PSBTError::OK : PSBTError::INCOMPLETE;
 }
 
+std::vector<PSBTError> SignPSBTInputs(std::span<const std::pair<unsigned int, const SigningProvider*>> inputs, PartiallySignedTransaction& psbt, const PrecomputedTransactionData* txdata, std::optional<int> sighash, bool finalize)
+{
+    // Each input is only read and written by the thread signing it, and the transaction and
+    // txdata are shared read-only, so contiguous chunks of inputs can be signed independently.
+    std::vector<PSBTError> results(inputs.size());
+    const int num_threads{std::clamp(std::min(GetNumCores(), int(inputs.size() / MIN_INPUTS_PER_SIGNING_THREAD)), 1, MAX_SIGNING_THREADS)};
+    std::vector<std::exception_ptr> errors(num_threads);
+    const auto sign_chunk = [&](int t) {
+        try {
+            for (size_t i = inputs.size() * t / num_threads; i < inputs.size() * (t + 1) / num_threads; ++i) {
+                const auto& [index, provider] = inputs[i];
+                results[i] = SignPSBTInput(*provider, psbt, index, txdata, sighash, nullptr, finalize);
+            }
+        } catch (...) {
+            errors[t] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            util::ThreadRename(strprintf("psbtsign.%i", t));
+            sign_chunk(t);
+        });
+    }
+    sign_chunk(0);
+    for (auto& thread : threads) thread.join();
+
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+    return results;
+}
+
 void RemoveUnnecessaryTransactions(PartiallySignedTransaction& psbtx)
 {
     // Figure out if any non_witness_utxos should be dropped
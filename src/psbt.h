@@ -17,6 +17,9 @@
 #include <streams.h>
 
 #include <optional>
+#include <span>
+#include <utility>
+#include <vector>
 
 namespace node {
 enum class TransactionError;
@@ -1397,7 +1400,7 @@ PrecomputedTransactionData PrecomputePSBTData(const PartiallySignedTransaction&
 bool PSBTInputSigned(const PSBTInput& input);
 
 /** Checks whether a PSBTInput is already signed by doing script verification using final fields. */
-bool PSBTInputSignedAndVerified(const PartiallySignedTransaction psbt, unsigned int input_index, const PrecomputedTransactionData* txdata);
+bool PSBTInputSignedAndVerified(const PartiallySignedTransaction& psbt, unsigned int input_index, const PrecomputedTransactionData* txdata);
 
 /** Signs a PSBTInput, verifying that all provided data matches what is being signed.
  *
@@ -1406,6 +1409,14 @@ bool PSBTInputSignedAndVerified(const PartiallySignedTransaction psbt, unsigned
  **/
 [[nodiscard]] PSBTError SignPSBTInput(const SigningProvider& provider, PartiallySignedTransaction& psbt, int index, const PrecomputedTransactionData* txdata, std::optional<int> sighash = std::nullopt, SignatureData* out_sigdata = nullptr, bool finalize = true);
 
+/** Signs several PSBTInputs, as SignPSBTInput does for each of them.
+ *
+ * inputs pairs the index of each input to sign, which must all be different, with the
+ * provider for its keys. All inputs share txdata. Large batches are signed on several
+ * threads. Returns the result for each input, in the order of inputs.
+ **/
+[[nodiscard]] std::vector<PSBTError> SignPSBTInputs(std::span<const std::pair<unsigned int, const SigningProvider*>> inputs, PartiallySignedTransaction& psbt, const PrecomputedTransactionData* txdata, std::optional<int> sighash = std::nullopt, bool finalize = true);
+
 /**  Reduces the size of the PSBT by dropping unnecessary `non_witness_utxos` (i.e. complete previous transactions) from a psbt when all inputs are segwit v1. */
 void RemoveUnnecessaryTransactions(PartiallySignedTransaction& psbtx);
 
@@ -13,8 +13,10 @@
 #include <core_io.h>
 #include <flatfile.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
 #include <index/txindex.h>
+#include <key_io.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <primitives/block.h>
@@ -34,6 +36,9 @@
 #include <validation.h>
 
 #include <any>
+#include <optional>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include <univalue.h>
@@ -44,6 +49,8 @@ using util::SplitString;
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
 static constexpr unsigned int MAX_REST_HEADERS_RESULTS = 2000;
+//! Size of the chunks in which large JSON replies are sent
+static constexpr size_t REST_JSON_CHUNK_SIZE{64 << 10};
 
 static const struct {
     RESTResponseFormat rf;
@@ -76,6 +83,55 @@ static bool RESTERR(HTTPRequest* req, enum HTTPStatusCode status, std::string me
     return false;
 }
 
+/**
+ * A JSON reply sent in chunks while it is written, so large replies are never
+ * held in memory at once. Replies smaller than a chunk are sent as a whole.
+ */
+class RESTJSONReply
+{
+    HTTPRequest* const m_req;
+    std::string m_buffer;
+    bool m_started{false};
+    bool m_client_gone{false};
+
+    void Flush()
+    {
+        if (!m_started) {
+            m_req->WriteHeader("Content-Type", "application/json");
+            m_req->StartChunkedReply(HTTP_OK);
+            m_started = true;
+        }
+        if (!m_client_gone && !m_req->WriteReplyChunk(std::exchange(m_buffer, {}))) {
+            m_client_gone = true;
+        }
+    }
+
+public:
+    explicit RESTJSONReply(HTTPRequest* req) : m_req{req} {}
+
+    /** Append to the reply. Returns false once the client went away, so the rest of the reply need not be generated. */
+    bool Write(std::string_view json)
+    {
+        if (m_started && !m_client_gone && m_req->IsChunkedReplyClosed()) m_client_gone = true;
+        if (m_client_gone) return false;
+        m_buffer += json;
+        if (m_buffer.size() >= REST_JSON_CHUNK_SIZE) Flush();
+        return !m_client_gone;
+    }
+
+    void End()
+    {
+        m_buffer += "\n";
+        if (!m_started) {
+            m_req->WriteHeader("Content-Type", "application/json");
+            m_req->WriteReply(HTTP_OK, std::move(m_buffer));
+            return;
+        }
+        Flush();
+        m_req->EndChunkedReply();
+    }
+};
+
 /**
  * Get the node context.
  *
@@ -449,10 +505,10 @@ static bool rest_block(const std::any& context,
         CBlock block{};
         DataStream block_stream{block_data};
         block_stream >> TX_WITH_WITNESS(block);
-        UniValue objBlock = blockToJSON(chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, chainman.GetConsensus().powLimit);
-        std::string strJSON = objBlock.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        RESTJSONReply reply{req};
+        WriteBlockJSON(chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, chainman.GetConsensus().powLimit,
+                       [&](std::string_view json) { return reply.Write(json); });
+        reply.End();
         return true;
     }
 
@@ -795,7 +851,10 @@ static bool rest_mempool(const std::any& context, HTTPRequest* req, const std::s
             if (verbose && mempool_sequence) {
                 return RESTERR(req, HTTP_BAD_REQUEST, "Verbose results cannot contain mempool sequence values. (hint: set \"verbose=false\")");
             }
-            str_json = MempoolToJSON(*mempool, verbose, mempool_sequence).write() + "\n";
+            RESTJSONReply reply{req};
+            WriteMempoolJSON(*mempool, verbose, mempool_sequence, [&](std::string_view json) { return reply.Write(json); });
+            reply.End();
+            return true;
         } else {
             str_json = MempoolInfoToJSON(*mempool).write() + "\n";
         }
@@ -1113,6 +1172,66 @@ static bool rest_blockhash_by_height(const std::any& context, HTTPRequest* req,
     }
 }
 
+static bool rest_address_history(const std::any& context, HTTPRequest* req, const std::string& uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string address;
+    const RESTResponseFormat rf = ParseDataFormat(address, uri_part);
+
+    if (!g_address_index) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, "Address index is not enabled");
+    }
+
+    const CTxDestination dest{DecodeDestination(address)};
+    if (!IsValidDestination(dest)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(address, SAFE_CHARS_URI));
+    }
+
+    std::optional<std::string> raw_after;
+    std::string raw_count;
+    try {
+        raw_after = req->GetQueryParameter("after");
+        raw_count = req->GetQueryParameter("count").value_or(util::ToString(MAX_ADDRESS_HISTORY_RESULTS));
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    std::optional<AddressIndexEntry> after;
+    if (raw_after) {
+        after = ParseAddressHistoryCursor(*raw_after);
+        if (!after) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid cursor: " + SanitizeString(*raw_after, SAFE_CHARS_URI));
+        }
+    }
+    const auto count{ToIntegral<size_t>(raw_count)};
+    if (!count || *count < 1 || *count > MAX_ADDRESS_HISTORY_RESULTS) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Count is invalid or out of acceptable range (1-%u): %s", MAX_ADDRESS_HISTORY_RESULTS, SanitizeString(raw_count, SAFE_CHARS_URI)));
+    }
+
+    switch (rf) {
+    case RESTResponseFormat::JSON: {
+        if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+            return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, "Address index is still syncing");
+        }
+        const IndexSummary summary{g_address_index->GetSummary()};
+        std::vector<AddressIndexEntry> entries;
+        if (!g_address_index->LookupScript(GetScriptForDestination(dest), after ? &*after : nullptr, *count, entries)) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Error reading from address index");
+        }
+
+        ChainstateManager* maybe_chainman = GetChainman(context, req);
+        if (!maybe_chainman) return false;
+        const std::string str_json{WITH_LOCK(cs_main, return AddressHistoryToJSON(maybe_chainman->ActiveChain(),
+            maybe_chainman->m_blockman.LookupBlockIndex(summary.best_block_hash), entries, *count)).write() + "\n"};
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, str_json);
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+    }
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(const std::any& context, HTTPRequest* req, const std::string& strReq);
@@ -1130,6 +1249,7 @@ static const struct {
       {"/rest/deploymentinfo", rest_deploymentinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
       {"/rest/spenttxouts/", rest_spent_txouts},
+      {"/rest/addresshistory/", rest_address_history},
 };
 
 void StartREST(const std::any& context)
@@ -12,6 +12,7 @@
 #include <clientversion.h>
 #include <coins.h>
 #include <common/args.h>
+#include <common/system.h>
 #include <consensus/amount.h>
 #include <consensus/params.h>
 #include <consensus/validation.h>
@@ -20,10 +21,12 @@
 #include <deploymentstatus.h>
 #include <flatfile.h>
 #include <hash.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
 #include <interfaces/mining.h>
 #include <kernel/coinstats.h>
+#include <key_io.h>
 #include <logging/timer.h>
 #include <net.h>
 #include <net_processing.h>
@@ -46,20 +49,30 @@
 #include <univalue.h>
 #include <util/check.h>
 #include <util/fs.h>
+#include <util/hasher.h>
 #include <util/strencodings.h>
+#include <util/string.h>
 #include <util/syserror.h>
+#include <util/thread.h>
+#include <util/threadnames.h>
 #include <util/translation.h>
 #include <validation.h>
 #include <validationinterface.h>
 #include <versionbits.h>
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 
 #include <condition_variable>
+#include <deque>
+#include <exception>
 #include <iterator>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
 using kernel::CCoinsStats;
@@ -71,6 +84,60 @@ using node::BlockManager;
 using node::NodeContext;
 using node::SnapshotMetadata;
 using util::MakeUnorderedList;
+using util::SplitString;
+
+namespace {
+//! Number of coins read ahead per batch while writing a UTXO snapshot
+constexpr size_t SNAPSHOT_BATCH_COINS{4096};
+//! Maximum number of batches read ahead while writing a UTXO snapshot
+constexpr size_t SNAPSHOT_MAX_BATCHES{16};
+
+/** The coins of one transaction, as written to a UTXO snapshot */
+struct SnapshotTxCoins {
+    Txid hash;
+    std::vector<std::pair<uint32_t, Coin>> coins;
+};
+
+/** Bounded queue handing batches of coins from the reading to the writing thread */
+class SnapshotBatchQueue
+{
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::vector<SnapshotTxCoins>> m_batches GUARDED_BY(m_mutex);
+    bool m_closed GUARDED_BY(m_mutex){false};
+
+public:
+    //! Add a batch, waiting while the queue is full. Returns false if the queue was closed.
+    bool Push(std::vector<SnapshotTxCoins>&& batch) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_closed || m_batches.size() < SNAPSHOT_MAX_BATCHES; });
+        if (m_closed) return false;
+        m_batches.push_back(std::move(batch));
+        m_cv.notify_all();
+        return true;
+    }
+
+    //! Take the next batch, waiting until one is available. Returns nullopt once the queue is closed and empty.
+    std::optional<std::vector<SnapshotTxCoins>> Pop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_closed || !m_batches.empty(); });
+        if (m_batches.empty()) return std::nullopt;
+        auto batch{std::move(m_batches.front())};
+        m_batches.pop_front();
+        m_cv.notify_all();
+        return batch;
+    }
+
+    void Close() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        m_closed = true;
+        m_cv.notify_all();
+    }
+};
+} // namespace
 
 std::tuple<std::unique_ptr<CCoinsViewCursor>, CCoinsStats, const CBlockIndex*>
 PrepareUTXOSnapshot(
@@ -178,20 +245,15 @@ UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex
     return result;
 }
 
-UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit)
+/** Call fn(tx_json) for each transaction of the block, in order, with the details given by verbosity,
+ * until fn returns false */
+template <typename Fn>
+static void ForEachBlockTxJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& blockindex, TxVerbosity verbosity, Fn&& fn)
 {
-    UniValue result = blockheaderToJSON(tip, blockindex, pow_limit);
-
-    result.pushKV("strippedsize", (int)::GetSerializeSize(TX_NO_WITNESS(block)));
-    result.pushKV("size", (int)::GetSerializeSize(TX_WITH_WITNESS(block)));
-    result.pushKV("weight", (int)::GetBlockWeight(block));
-    UniValue txs(UniValue::VARR);
-    txs.reserve(block.vtx.size());
-
     switch (verbosity) {
         case TxVerbosity::SHOW_TXID:
             for (const CTransactionRef& tx : block.vtx) {
-                txs.push_back(tx->GetHash().GetHex());
+                if (!fn(UniValue{tx->GetHash().GetHex()})) return;
             }
             break;
 
@@ -209,16 +271,56 @@ UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIn
                 const CTxUndo* txundo = (have_undo && i > 0) ? &blockUndo.vtxundo.at(i - 1) : nullptr;
                 UniValue objTx(UniValue::VOBJ);
                 TxToUniv(*tx, /*block_hash=*/uint256(), /*entry=*/objTx, /*include_hex=*/true, txundo, verbosity);
-                txs.push_back(std::move(objTx));
+                if (!fn(std::move(objTx))) return;
             }
             break;
     }
+}
+
+/** Block description to JSON, without the transactions */
+static UniValue blockSummaryToJSON(const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256 pow_limit)
+{
+    UniValue result = blockheaderToJSON(tip, blockindex, pow_limit);
+
+    result.pushKV("strippedsize", (int)::GetSerializeSize(TX_NO_WITNESS(block)));
+    result.pushKV("size", (int)::GetSerializeSize(TX_WITH_WITNESS(block)));
+    result.pushKV("weight", (int)::GetBlockWeight(block));
+    return result;
+}
+
+UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit)
+{
+    UniValue result = blockSummaryToJSON(block, tip, blockindex, pow_limit);
+    UniValue txs(UniValue::VARR);
+    txs.reserve(block.vtx.size());
+    ForEachBlockTxJSON(blockman, block, blockindex, verbosity, [&](UniValue&& tx) {
+        txs.push_back(std::move(tx));
+        return true;
+    });
 
     result.pushKV("tx", std::move(txs));
 
     return result;
 }
 
+void WriteBlockJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit, const std::function<bool(std::string_view)>& write)
+{
+    // The transactions are the last field of the object, so the summary is
+    // written without its closing brace, followed by one transaction at a time.
+    std::string summary{blockSummaryToJSON(block, tip, blockindex, pow_limit).write()};
+    summary.pop_back();
+    if (!write(summary + ",\"tx\":[")) return;
+    bool first{true};
+    bool stopped{false};
+    ForEachBlockTxJSON(blockman, block, blockindex, verbosity, [&](UniValue&& tx) {
+        stopped = !write((first ? "" : ",") + tx.write());
+        first = false;
+        return !stopped;
+    });
+    if (stopped) return;
+    write("]}");
+}
+
 static RPCHelpMan getblockcount()
 {
     return RPCHelpMan{
@@ -2140,32 +2242,142 @@ static RPCHelpMan getblockstats()
 }
 
 namespace {
-//! Search for a given set of pubkey scripts
-bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>& should_abort, int64_t& count, CCoinsViewCursor* cursor, const std::set<CScript>& needles, std::map<COutPoint, Coin>& out_results, std::function<void()>& interruption_point)
+//! Number of txid ranges the UTXO set is split into by scantxoutset
+constexpr unsigned int SCAN_SHARDS{16};
+//! Maximum number of additional threads scanning the UTXO set
+constexpr int MAX_SCAN_THREADS{7};
+
+/**
+ * The set of pubkey scripts searched for. The size of a coin's script is
+ * checked first, which rejects most coins without hashing their script.
+ */
+class ScriptNeedles
 {
-    scan_progress = 0;
-    count = 0;
+    std::unordered_set<CScript, SaltedSipHasher> m_scripts;
+    std::vector<bool> m_sizes;
+
+public:
+    explicit ScriptNeedles(const std::set<CScript>& scripts) : m_scripts(scripts.begin(), scripts.end())
+    {
+        for (const CScript& script : scripts) {
+            if (script.size() >= m_sizes.size()) m_sizes.resize(script.size() + 1);
+            m_sizes[script.size()] = true;
+        }
+    }
+
+    bool Contains(const CScript& script) const
+    {
+        return script.size() < m_sizes.size() && m_sizes[script.size()] && m_scripts.contains(script);
+    }
+};
+
+/** State shared by the threads scanning ranges of the UTXO set */
+struct ScanState {
+    std::atomic<int>& scan_progress;
+    const std::atomic<bool>& should_abort;
+    std::atomic<bool> failed{false};
+    std::atomic<int64_t> count{0};
+    std::array<std::atomic<int>, SCAN_SHARDS> shard_progress{};
+
+    void SetProgress(unsigned int shard, int progress)
+    {
+        shard_progress[shard] = progress;
+        int total{0};
+        for (const auto& p : shard_progress) total += p;
+        scan_progress = total / int{SCAN_SHARDS};
+    }
+};
+
+//! Search the range of txids belonging to a shard for a given set of pubkey scripts
+bool FindScriptPubKey(ScanState& state, unsigned int shard, CCoinsViewCursor* cursor, const ScriptNeedles& needles, std::map<COutPoint, Coin>& out_results, std::function<void()>* interruption_point)
+{
+    // The shard covers txids whose first byte is in [begin, end).
+    const uint32_t begin{shard * 256 / SCAN_SHARDS};
+    const uint32_t end{(shard + 1) * 256 / SCAN_SHARDS};
+    int64_t count = 0;
     while (cursor->Valid()) {
         COutPoint key;
         Coin coin;
-        if (!cursor->GetKey(key) || !cursor->GetValue(coin)) return false;
+        if (!cursor->GetKey(key)) return false;
+        const uint32_t first_byte{*UCharCast(key.hash.begin())};
+        if (first_byte >= end) break;
+        if (!cursor->GetValue(coin)) return false;
         if (++count % 8192 == 0) {
-            interruption_point();
-            if (should_abort) {
+            if (interruption_point) (*interruption_point)();
+            if (state.should_abort || state.failed) {
                 // allow to abort the scan via the abort reference
                 return false;
             }
         }
         if (count % 256 == 0) {
             // update progress reference every 256 item
-            uint32_t high = 0x100 * *UCharCast(key.hash.begin()) + *(UCharCast(key.hash.begin()) + 1);
-            scan_progress = (int)(high * 100.0 / 65536.0 + 0.5);
+            state.count += 256;
+            uint32_t high = 0x100 * first_byte + *(UCharCast(key.hash.begin()) + 1);
+            state.SetProgress(shard, (int)((high - 0x100 * begin) * 100.0 / (0x100 * (end - begin)) + 0.5));
         }
-        if (needles.count(coin.out.scriptPubKey)) {
+        if (needles.Contains(coin.out.scriptPubKey)) {
             out_results.emplace(key, coin);
         }
         cursor->Next();
     }
+    state.count += count % 256;
+    state.SetProgress(shard, 100);
+    return true;
+}
+
+/**
+ * Search the UTXO set for a given set of pubkey scripts. Each cursor is
+ * positioned at the start of its shard; the shards are scanned concurrently.
+ * Only the calling thread runs the interruption point.
+ */
+bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>& should_abort, int64_t& count, const std::vector<std::unique_ptr<CCoinsViewCursor>>& cursors, const ScriptNeedles& needles, std::map<COutPoint, Coin>& out_results, std::function<void()>& interruption_point)
+{
+    CHECK_NONFATAL(cursors.size() == SCAN_SHARDS);
+    scan_progress = 0;
+    ScanState state{scan_progress, should_abort};
+    std::vector<std::map<COutPoint, Coin>> shard_results(SCAN_SHARDS);
+    std::atomic<unsigned int> next_shard{0};
+    const auto scan{[&](std::function<void()>* interruption) {
+        for (unsigned int shard; (shard = next_shard++) < SCAN_SHARDS;) {
+            if (!FindScriptPubKey(state, shard, cursors[shard].get(), needles, shard_results[shard], interruption)) {
+                state.failed = true;
+                return;
+            }
+        }
+    }};
+
+    std::vector<std::thread> threads;
+    const int n_threads{std::clamp(GetNumCores() - 1, 0, MAX_SCAN_THREADS)};
+    // Errors of the worker threads are rethrown on the calling thread.
+    std::vector<std::exception_ptr> errors(n_threads);
+    for (int i = 0; i < n_threads; ++i) {
+        threads.emplace_back([&, i] {
+            util::ThreadRename(strprintf("scantxout.%i", i));
+            try {
+                scan(nullptr);
+            } catch (...) {
+                errors[i] = std::current_exception();
+                state.failed = true;
+            }
+        });
+    }
+    try {
+        scan(&interruption_point);
+    } catch (...) {
+        state.failed = true;
+        for (auto& thread : threads) thread.join();
+        throw;
+    }
+    for (auto& thread : threads) thread.join();
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+
+    count = state.count;
+    if (state.failed) return false;
+    for (auto& results : shard_results) {
+        out_results.merge(results);
+    }
     scan_progress = 100;
     return true;
 }
@@ -2352,7 +2564,7 @@ static RPCHelpMan scantxoutset()
         std::map<COutPoint, Coin> coins;
         g_should_abort_scan = false;
         int64_t count = 0;
-        std::unique_ptr<CCoinsViewCursor> pcursor;
+        std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
         const CBlockIndex* tip;
         NodeContext& node = EnsureAnyNodeContext(request.context);
         {
@@ -2360,10 +2572,15 @@ static RPCHelpMan scantxoutset()
             LOCK(cs_main);
             Chainstate& active_chainstate = chainman.ActiveChainstate();
             active_chainstate.ForceFlushStateToDisk();
-            pcursor = CHECK_NONFATAL(active_chainstate.CoinsDB().Cursor());
+            // All cursors are created under cs_main, so they read the same state of the UTXO set.
+            for (unsigned int shard = 0; shard < SCAN_SHARDS; ++shard) {
+                uint256 start;
+                *start.begin() = shard * 256 / SCAN_SHARDS;
+                cursors.push_back(CHECK_NONFATAL(active_chainstate.CoinsDB().Cursor(COutPoint{Txid::FromUint256(start), 0})));
+            }
             tip = CHECK_NONFATAL(active_chainstate.m_chain.Tip());
         }
-        bool res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, pcursor.get(), needles, coins, node.rpc_interruption_point);
+        bool res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, cursors, ScriptNeedles{needles}, coins, node.rpc_interruption_point);
         result.pushKV("success", res);
         result.pushKV("txouts", count);
         result.pushKV("height", tip->nHeight);
@@ -2599,9 +2816,14 @@ static RPCHelpMan scanblocks()
                     stop_block;
 
             if (index->LookupFilterRange(start_block, end_range, filters)) {
-                for (const BlockFilter& filter : filters) {
-                    // compare the elements-set with each filter
-                    if (filter.GetFilter().MatchAny(needle_set)) {
+                // compare the elements-set with each filter
+                std::vector<const GCSFilter*> gcs_filters;
+                gcs_filters.reserve(filters.size());
+                for (const BlockFilter& filter : filters) gcs_filters.push_back(&filter.GetFilter());
+                const std::vector<bool> matches = GCSFilter::MatchAnyMany(gcs_filters, needle_set);
+                for (size_t i = 0; i < filters.size(); ++i) {
+                    const BlockFilter& filter = filters[i];
+                    if (matches[i]) {
                         if (filter_false_positives) {
                             // Double check the filter matches by scanning the block
                             const CBlockIndex& blockindex = *CHECK_NONFATAL(WITH_LOCK(cs_main, return chainman.m_blockman.LookupBlockIndex(filter.GetBlockHash())));
@@ -2878,6 +3100,130 @@ static RPCHelpMan getdescriptoractivity()
     };
 }
 
+/** Cursor pointing at the position of an address index entry, as returned in "next". */
+static std::string AddressHistoryCursor(const AddressIndexEntry& entry)
+{
+    return strprintf("%d:%u:%d:%u", entry.height, entry.tx_pos, entry.spending, entry.index);
+}
+
+std::optional<AddressIndexEntry> ParseAddressHistoryCursor(std::string_view cursor)
+{
+    const std::vector<std::string> parts{SplitString(cursor, ':')};
+    if (parts.size() != 4) return std::nullopt;
+    const auto height{ToIntegral<int>(parts[0])};
+    const auto tx_pos{ToIntegral<uint32_t>(parts[1])};
+    const auto spending{ToIntegral<uint8_t>(parts[2])};
+    const auto index{ToIntegral<uint32_t>(parts[3])};
+    if (!height || *height < 0 || !tx_pos || !spending || *spending > 1 || !index) return std::nullopt;
+    AddressIndexEntry entry;
+    entry.height = *height;
+    entry.tx_pos = *tx_pos;
+    entry.spending = *spending;
+    entry.index = *index;
+    return entry;
+}
+
+UniValue AddressHistoryToJSON(const CChain& active_chain, const CBlockIndex* index_best_block, const std::vector<AddressIndexEntry>& entries, size_t count)
+{
+    AssertLockHeld(::cs_main);
+    // Entries above the point where the index's best block forks from the active chain
+    // may be from a block that was reorganized out, or that the index was still connecting.
+    const CBlockIndex* fork{index_best_block ? active_chain.FindFork(index_best_block) : nullptr};
+    const int confirmed_height{fork ? fork->nHeight : -1};
+    UniValue history(UniValue::VARR);
+    for (const AddressIndexEntry& entry : entries) {
+        UniValue event(UniValue::VOBJ);
+        event.pushKV("type", entry.spending ? "spend" : "receive");
+        event.pushKV("amount", ValueFromAmount(entry.amount));
+        if (entry.height <= confirmed_height) {
+            event.pushKV("blockhash", active_chain[entry.height]->GetBlockHash().GetHex());
+        }
+        event.pushKV("height", entry.height);
+        event.pushKV("txid", entry.txid.GetHex());
+        event.pushKV(entry.spending ? "vin" : "vout", entry.index);
+        history.push_back(std::move(event));
+    }
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("history", std::move(history));
+    if (!entries.empty() && entries.size() == count) {
+        ret.pushKV("next", AddressHistoryCursor(entries.back()));
+    }
+    return ret;
+}
+
+static RPCHelpMan getaddresshistory()
+{
+    return RPCHelpMan{
+        "getaddresshistory",
+        "Get the confirmed transactions funding and spending an address, oldest first.\n"
+        "Requires -addressindex. Results are paged: pass the \"next\" cursor of a result as \"after\" to get the following entries.",
+        {
+            {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The address to look up"},
+            {"after", RPCArg::Type::STR, RPCArg::DefaultHint{"list from the first entry"}, "The \"next\" cursor returned by a previous call"},
+            {"count", RPCArg::Type::NUM, RPCArg::Default{MAX_ADDRESS_HISTORY_RESULTS}, strprintf("The maximum number of entries to return (1-%u)", MAX_ADDRESS_HISTORY_RESULTS)},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "", {
+                {RPCResult::Type::ARR, "history", "", {
+                    {RPCResult::Type::OBJ, "", "", {
+                        {RPCResult::Type::STR, "type", "'receive' for an output paying to the address, 'spend' for an input spending from it"},
+                        {RPCResult::Type::STR_AMOUNT, "amount", "The amount in " + CURRENCY_UNIT + " received or spent"},
+                        {RPCResult::Type::STR_HEX, "blockhash", /*optional=*/true, "The block containing the transaction (omitted if that block is no longer in the active chain)"},
+                        {RPCResult::Type::NUM, "height", "The height of the block containing the transaction"},
+                        {RPCResult::Type::STR_HEX, "txid", "The txid of the transaction"},
+                        {RPCResult::Type::NUM, "vout", /*optional=*/true, "The index of the output (receive only)"},
+                        {RPCResult::Type::NUM, "vin", /*optional=*/true, "The index of the input (spend only)"},
+                    }},
+                }},
+                {RPCResult::Type::STR, "next", /*optional=*/true, "Cursor to pass as \"after\" to get the following entries (omitted if the history ends within this result)"},
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\"")
+            + HelpExampleCli("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\" \"123456:7:0:1\" 100")
+            + HelpExampleRpc("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\"")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    if (!g_address_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index not enabled. Use -addressindex");
+    }
+
+    const CTxDestination dest{DecodeDestination(request.params[0].get_str())};
+    if (!IsValidDestination(dest)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
+    }
+    std::optional<AddressIndexEntry> after;
+    if (!request.params[1].isNull()) {
+        after = ParseAddressHistoryCursor(request.params[1].get_str());
+        if (!after) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        }
+    }
+    const int64_t count{request.params[2].isNull() ? MAX_ADDRESS_HISTORY_RESULTS : request.params[2].getInt<int64_t>()};
+    if (count < 1 || count > MAX_ADDRESS_HISTORY_RESULTS) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("count must be between 1 and %u", MAX_ADDRESS_HISTORY_RESULTS));
+    }
+
+    if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+        const IndexSummary summary{g_address_index->GetSummary()};
+        throw JSONRPCError(RPC_INTERNAL_ERROR, strprintf("Unable to get data because addressindex is still syncing. Current height: %d", summary.best_block_height));
+    }
+
+    // The index's best block is read before the entries, so that it covers all of them.
+    const IndexSummary summary{g_address_index->GetSummary()};
+    std::vector<AddressIndexEntry> entries;
+    if (!g_address_index->LookupScript(GetScriptForDestination(dest), after ? &*after : nullptr, count, entries)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Error reading from address index");
+    }
+
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    LOCK(::cs_main);
+    return AddressHistoryToJSON(chainman.ActiveChain(), chainman.m_blockman.LookupBlockIndex(summary.best_block_hash), entries, count);
+},
+    };
+}
+
 static RPCHelpMan getblockfilter()
 {
     return RPCHelpMan{
@@ -3211,49 +3557,69 @@ UniValue WriteUTXOSnapshot(
 
     afile << metadata;
 
-    COutPoint key;
-    Txid last_hash;
-    Coin coin;
-    unsigned int iter{0};
     size_t written_coins_count{0};
-    std::vector<std::pair<uint32_t, Coin>> coins;
 
     // To reduce space the serialization format of the snapshot avoids
     // duplication of tx hashes. The code takes advantage of the guarantee by
     // leveldb that keys are lexicographically sorted.
-    // In the coins vector we collect all coins that belong to a certain tx hash
-    // (key.hash) and when we have them all (key.hash != last_hash) we write
-    // them to file using the below lambda function.
+    // The coins are read from the database by a separate thread, which groups
+    // all coins that belong to a certain tx hash and hands them over in
+    // batches, while this thread writes them to file.
     // See also https://github.com/bitcoin/bitcoin/issues/25675
-    auto write_coins_to_file = [&](AutoFile& afile, const Txid& last_hash, const std::vector<std::pair<uint32_t, Coin>>& coins, size_t& written_coins_count) {
-        afile << last_hash;
-        WriteCompactSize(afile, coins.size());
-        for (const auto& [n, coin] : coins) {
+    auto write_coins_to_file = [&](AutoFile& afile, const SnapshotTxCoins& tx_coins, size_t& written_coins_count) {
+        afile << tx_coins.hash;
+        WriteCompactSize(afile, tx_coins.coins.size());
+        for (const auto& [n, coin] : tx_coins.coins) {
             WriteCompactSize(afile, n);
             afile << coin;
             ++written_coins_count;
         }
     };
 
-    pcursor->GetKey(key);
-    last_hash = key.hash;
-    while (pcursor->Valid()) {
-        if (iter % 5000 == 0) interruption_point();
-        ++iter;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
-            if (key.hash != last_hash) {
-                write_coins_to_file(afile, last_hash, coins, written_coins_count);
-                last_hash = key.hash;
-                coins.clear();
+    SnapshotBatchQueue queue;
+    std::exception_ptr reader_error;
+    std::thread reader(&util::TraceThread, "dumptxout", [&] {
+        try {
+            std::vector<SnapshotTxCoins> batch;
+            size_t batch_coins{0};
+            COutPoint key;
+            Coin coin;
+            while (pcursor->Valid()) {
+                if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
+                    if (batch.empty() || key.hash != batch.back().hash) {
+                        if (batch_coins >= SNAPSHOT_BATCH_COINS) {
+                            if (!queue.Push(std::move(batch))) return;
+                            batch.clear();
+                            batch_coins = 0;
+                        }
+                        batch.push_back({key.hash, {}});
+                    }
+                    batch.back().coins.emplace_back(key.n, coin);
+                    ++batch_coins;
+                }
+                pcursor->Next();
             }
-            coins.emplace_back(key.n, coin);
+            if (!batch.empty()) queue.Push(std::move(batch));
+        } catch (...) {
+            reader_error = std::current_exception();
         }
-        pcursor->Next();
-    }
+        queue.Close();
+    });
 
-    if (!coins.empty()) {
-        write_coins_to_file(afile, last_hash, coins, written_coins_count);
+    try {
+        while (auto batch{queue.Pop()}) {
+            interruption_point();
+            for (const SnapshotTxCoins& tx_coins : *batch) {
+                write_coins_to_file(afile, tx_coins, written_coins_count);
+            }
+        }
+    } catch (...) {
+        queue.Close();
+        reader.join();
+        throw;
     }
+    reader.join();
+    if (reader_error) std::rethrow_exception(reader_error);
 
     CHECK_NONFATAL(written_coins_count == maybe_stats->coins_count);
 
@@ -3468,6 +3834,7 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &scantxoutset},
         {"blockchain", &scanblocks},
         {"blockchain", &getdescriptoractivity},
+        {"blockchain", &getaddresshistory},
         {"blockchain", &getblockfilter},
         {"blockchain", &dumptxoutset},
         {"blockchain", &loadtxoutset},
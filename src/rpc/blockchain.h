@@ -14,10 +14,15 @@
 
 #include <any>
 #include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
 #include <vector>
 
+struct AddressIndexEntry;
 class CBlock;
 class CBlockIndex;
+class CChain;
 class Chainstate;
 class UniValue;
 namespace node {
@@ -38,9 +43,28 @@ double GetDifficulty(const CBlockIndex& blockindex);
 /** Block description to JSON */
 UniValue blockToJSON(node::BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
 
+/**
+ * Block description to JSON, written in pieces of at most one transaction
+ * each, so the JSON of a large block is never held in memory at once. The
+ * concatenated pieces equal blockToJSON(...).write(). Writing stops early
+ * if write returns false.
+ */
+void WriteBlockJSON(node::BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit, const std::function<bool(std::string_view)>& write) LOCKS_EXCLUDED(cs_main);
+
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
 
+/**
+ * Address index entries to JSON, as returned by getaddresshistory. Block hashes are
+ * only reported for entries that are in the active chain as of index_best_block, the
+ * index's best block read before the lookup. A "next" cursor is added if the lookup
+ * returned count entries.
+ */
+UniValue AddressHistoryToJSON(const CChain& active_chain, const CBlockIndex* index_best_block, const std::vector<AddressIndexEntry>& entries, size_t count) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+/** Parse a "next" cursor of getaddresshistory into the position it points at. */
+std::optional<AddressIndexEntry> ParseAddressHistoryCursor(std::string_view cursor);
+
 /** Used by getblockstats to get feerates at different percentiles by weight  */
 void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight);
 
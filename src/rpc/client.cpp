@@ -94,6 +94,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getdescriptoractivity", 0, "blockhashes" },
     { "getdescriptoractivity", 1, "scanobjects" },
     { "getdescriptoractivity", 2, "include_mempool" },
+    { "getaddresshistory", 2, "count" },
     { "scantxoutset", 1, "scanobjects" },
     { "createmultisig", 0, "nrequired" },
     { "createmultisig", 1, "keys" },
@@ -245,6 +246,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getblockstats", 1, "stats" },
     { "pruneblockchain", 0, "height" },
     { "keypoolrefill", 0, "newsize" },
+    { "getnewaddresses", 0, "count" },
     { "getrawmempool", 0, "verbose" },
     { "getrawmempool", 1, "mempool_sequence" },
     { "getorphantxs", 0, "verbosity" },
@@ -10,6 +10,7 @@
 #include <chainparams.h>
 #include <consensus/validation.h>
 #include <core_io.h>
+#include <index/txospenderindex.h>
 #include <kernel/mempool_entry.h>
 #include <net_processing.h>
 #include <node/mempool_persist_args.h>
@@ -28,6 +29,7 @@
 #include <util/time.h>
 #include <util/vector.h>
 
+#include <algorithm>
 #include <utility>
 
 using node::DumpMempool;
@@ -286,6 +288,9 @@ static std::vector<RPCResult> MempoolEntryDescription()
     };
 }
 
+/** Number of entries described at a time by WriteMempoolJSON */
+static constexpr size_t MEMPOOL_JSON_BATCH_SIZE{1000};
+
 static void entryToJSON(const CTxMemPool& pool, UniValue& info, const CTxMemPoolEntry& e) EXCLUSIVE_LOCKS_REQUIRED(pool.cs)
 {
     AssertLockHeld(pool.cs);
@@ -381,6 +386,45 @@ UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose, bool include_mempoo
     }
 }
 
+void WriteMempoolJSON(const CTxMemPool& pool, bool verbose, bool include_mempool_sequence, const std::function<bool(std::string_view)>& write)
+{
+    if (!verbose) {
+        write(MempoolToJSON(pool, verbose, include_mempool_sequence).write());
+        return;
+    }
+    std::vector<Txid> txids;
+    {
+        LOCK(pool.cs);
+        const auto entries{pool.entryAll()};
+        txids.reserve(entries.size());
+        for (const CTxMemPoolEntry& e : entries) {
+            txids.push_back(e.GetTx().GetHash());
+        }
+    }
+    // Only hold the mempool lock while describing a batch of entries, not
+    // while they are written out. Entries that left the mempool in the
+    // meantime are skipped.
+    if (!write("{")) return;
+    bool first{true};
+    for (size_t start{0}; start < txids.size(); start += MEMPOOL_JSON_BATCH_SIZE) {
+        std::string batch;
+        {
+            LOCK(pool.cs);
+            for (size_t i{start}; i < std::min(start + MEMPOOL_JSON_BATCH_SIZE, txids.size()); ++i) {
+                const auto it{pool.GetIter(txids[i])};
+                if (!it) continue;
+                UniValue info(UniValue::VOBJ);
+                entryToJSON(pool, info, **it);
+                if (!first) batch += ",";
+                batch += UniValue{txids[i].ToString()}.write() + ":" + info.write();
+                first = false;
+            }
+        }
+        if (!write(batch)) return;
+    }
+    write("}");
+}
+
 static RPCHelpMan getrawmempool()
 {
     return RPCHelpMan{
@@ -596,7 +640,8 @@ static RPCHelpMan getmempoolentry()
 static RPCHelpMan gettxspendingprevout()
 {
     return RPCHelpMan{"gettxspendingprevout",
-        "Scans the mempool to find transactions spending any of the given outputs",
+        "Scans the mempool to find transactions spending any of the given outputs.\n"
+        "With -txospenderindex, outputs spent in the active chain are also reported, along with the block containing the spend.",
         {
             {"outputs", RPCArg::Type::ARR, RPCArg::Optional::NO, "The transaction outputs that we want to check, and within each, the txid (string) vout (numeric).",
                 {
@@ -616,7 +661,8 @@ static RPCHelpMan gettxspendingprevout()
                 {
                     {RPCResult::Type::STR_HEX, "txid", "the transaction id of the checked output"},
                     {RPCResult::Type::NUM, "vout", "the vout value of the checked output"},
-                    {RPCResult::Type::STR_HEX, "spendingtxid", /*optional=*/true, "the transaction id of the mempool transaction spending this output (omitted if unspent)"},
+                    {RPCResult::Type::STR_HEX, "spendingtxid", /*optional=*/true, "the transaction id of the mempool transaction spending this output, or of the confirmed transaction spending it if -txospenderindex is enabled (omitted if unspent)"},
+                    {RPCResult::Type::STR_HEX, "blockhash", /*optional=*/true, "the hash of the block containing the confirmed spending transaction (only if -txospenderindex is enabled and the output is spent in the active chain)"},
                 }},
             }
         },
@@ -652,19 +698,62 @@ static RPCHelpMan gettxspendingprevout()
                 prevouts.emplace_back(txid, nOutput);
             }
 
+            // Look up confirmed spends in one batch before locking the mempool. The index's
+            // best block is read first, so that it covers all the spends found.
+            std::vector<std::optional<TxoSpender>> confirmed_spenders(prevouts.size());
+            uint256 index_best_block_hash;
+            if (g_txospender_index) {
+                if (!g_txospender_index->BlockUntilSyncedToCurrentChain()) {
+                    const IndexSummary summary{g_txospender_index->GetSummary()};
+                    throw JSONRPCError(RPC_INTERNAL_ERROR, strprintf("Unable to get data because txospenderindex is still syncing. Current height: %d", summary.best_block_height));
+                }
+                index_best_block_hash = g_txospender_index->GetSummary().best_block_hash;
+                confirmed_spenders = g_txospender_index->FindSpenders(prevouts);
+            }
+
             const CTxMemPool& mempool = EnsureAnyMemPool(request.context);
-            LOCK(mempool.cs);
+            std::vector<std::optional<Txid>> mempool_spenders(prevouts.size());
+            {
+                LOCK(mempool.cs);
+                for (size_t i = 0; i < prevouts.size(); ++i) {
+                    if (const CTransaction* spendingTx{mempool.GetConflictTx(prevouts[i])}) {
+                        mempool_spenders[i] = spendingTx->GetHash();
+                    }
+                }
+            }
+
+            // Only confirmed spends need the chain. A spend is in the active chain if its height
+            // is not above where the active chain forks from the index's best block; above that
+            // it may be in a block that was reorganized out since.
+            std::vector<std::optional<uint256>> spender_block_hashes(prevouts.size());
+            if (g_txospender_index) {
+                ChainstateManager& chainman = EnsureAnyChainman(request.context);
+                LOCK(::cs_main);
+                const CChain& active_chain = chainman.ActiveChain();
+                const CBlockIndex* index_best_block{chainman.m_blockman.LookupBlockIndex(index_best_block_hash)};
+                const CBlockIndex* fork{index_best_block ? active_chain.FindFork(index_best_block) : nullptr};
+                for (size_t i = 0; i < prevouts.size(); ++i) {
+                    if (const auto& spender{confirmed_spenders[i]}; spender && !mempool_spenders[i] && fork && spender->height <= fork->nHeight) {
+                        spender_block_hashes[i] = active_chain[spender->height]->GetBlockHash();
+                    }
+                }
+            }
 
             UniValue result{UniValue::VARR};
 
-            for (const COutPoint& prevout : prevouts) {
+            for (size_t i = 0; i < prevouts.size(); ++i) {
+                const COutPoint& prevout = prevouts[i];
                 UniValue o(UniValue::VOBJ);
                 o.pushKV("txid", prevout.hash.ToString());
                 o.pushKV("vout", (uint64_t)prevout.n);
 
-                const CTransaction* spendingTx = mempool.GetConflictTx(prevout);
-                if (spendingTx != nullptr) {
-                    o.pushKV("spendingtxid", spendingTx->GetHash().ToString());
+                if (const auto& spending_txid{mempool_spenders[i]}) {
+                    o.pushKV("spendingtxid", spending_txid->ToString());
+                } else if (const auto& spender{confirmed_spenders[i]}) {
+                    o.pushKV("spendingtxid", spender->txid.ToString());
+                    if (const auto& block_hash{spender_block_hashes[i]}) {
+                        o.pushKV("blockhash", block_hash->GetHex());
+                    }
                 }
 
                 result.push_back(std::move(o));
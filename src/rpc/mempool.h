@@ -5,6 +5,9 @@
 #ifndef BITCOIN_RPC_MEMPOOL_H
 #define BITCOIN_RPC_MEMPOOL_H
 
+#include <functional>
+#include <string_view>
+
 class CTxMemPool;
 class UniValue;
 
@@ -14,4 +17,13 @@ UniValue MempoolInfoToJSON(const CTxMemPool& pool);
 /** Mempool to JSON */
 UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose = false, bool include_mempool_sequence = false);
 
+/**
+ * Mempool to JSON, written in pieces so the JSON of a large mempool is never
+ * held in memory at once. Verbose entries are described in batches, and
+ * entries leaving the mempool while it is written are omitted. Writing
+ * stops early if write returns false. Verbose results cannot contain the
+ * mempool sequence, so include_mempool_sequence must be false if verbose is.
+ */
+void WriteMempoolJSON(const CTxMemPool& pool, bool verbose, bool include_mempool_sequence, const std::function<bool(std::string_view)>& write);
+
 #endif // BITCOIN_RPC_MEMPOOL_H
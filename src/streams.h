@@ -16,6 +16,7 @@
 #include <util/syserror.h>
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -296,6 +297,30 @@ public:
         }
         return data;
     }
+
+    /** Read a unary-encoded number: the count of 1 bits up to the next 0 bit,
+     * which is consumed but not counted. Runs of 1 bits are counted a whole
+     * buffered byte at a time.
+     */
+    uint64_t ReadUnary() {
+        uint64_t count = 0;
+        while (true) {
+            if (m_offset == 8) {
+                m_istream >> m_buffer;
+                m_offset = 0;
+            }
+
+            // The bits already returned are shifted out and replaced by 0 bits
+            // at the bottom, so the count stops at the end of the buffer.
+            const int ones = std::countl_one(static_cast<uint8_t>(m_buffer << m_offset));
+            count += ones;
+            if (m_offset + ones < 8) {
+                m_offset += ones + 1;
+                return count;
+            }
+            m_offset = 8;
+        }
+    }
 };
 
 template <typename OStream>
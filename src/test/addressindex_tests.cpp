@@ -0,0 +1,97 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <index/addressindex.h>
+#include <interfaces/chain.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(addressindex_initial_sync, TestChain100Setup)
+{
+    AddressIndex address_index(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(address_index.Init());
+
+    const CScript coinbase_script{m_coinbase_txns.front()->vout.at(0).scriptPubKey};
+    std::vector<AddressIndexEntry> entries;
+
+    // Nothing should be found in the index before it is started.
+    BOOST_CHECK(address_index.LookupScript(coinbase_script, /*after=*/nullptr, 1000, entries));
+    BOOST_CHECK(entries.empty());
+
+    address_index.Sync();
+
+    // Every coinbase of the 100 blocks pays to the same script, oldest first.
+    BOOST_CHECK(address_index.LookupScript(coinbase_script, /*after=*/nullptr, 1000, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), m_coinbase_txns.size());
+    for (size_t i{0}; i < entries.size(); ++i) {
+        BOOST_CHECK_EQUAL(entries[i].height, int(i + 1));
+        BOOST_CHECK(!entries[i].spending);
+        BOOST_CHECK_EQUAL(entries[i].tx_pos, 0U);
+        BOOST_CHECK_EQUAL(entries[i].index, 0U);
+        BOOST_CHECK(entries[i].txid == m_coinbase_txns[i]->GetHash());
+        BOOST_CHECK_EQUAL(entries[i].amount, m_coinbase_txns[i]->vout.at(0).nValue);
+    }
+
+    // Paging from an entry returns the entries after it in order.
+    std::vector<AddressIndexEntry> page;
+    BOOST_CHECK(address_index.LookupScript(coinbase_script, &entries[9], 5, page));
+    BOOST_REQUIRE_EQUAL(page.size(), 5U);
+    BOOST_CHECK_EQUAL(page.front().height, entries[10].height);
+    BOOST_CHECK_EQUAL(page.back().height, entries[14].height);
+
+    // A position between entries pages from the next entry.
+    AddressIndexEntry between{entries[9]};
+    between.spending = true;
+    page.clear();
+    BOOST_CHECK(address_index.LookupScript(coinbase_script, &between, 1, page));
+    BOOST_REQUIRE_EQUAL(page.size(), 1U);
+    BOOST_CHECK_EQUAL(page.front().height, entries[10].height);
+
+    // Spend the first coinbase to a new script and check both sides are recorded.
+    const CScript recipient_script{GetScriptForDestination(WitnessV0KeyHash(GenerateRandomKey().GetPubKey()))};
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[0], /*input_vout=*/0, /*input_height=*/0,
+                                                                  coinbaseKey, recipient_script, /*output_amount=*/1 * COIN, /*submit=*/false)};
+    const CBlock block{CreateAndProcessBlock({spend}, coinbase_script)};
+    BOOST_CHECK(address_index.BlockUntilSyncedToCurrentChain());
+    const int height{WITH_LOCK(::cs_main, return m_node.chainman->ActiveHeight())};
+
+    std::vector<AddressIndexEntry> received;
+    BOOST_CHECK(address_index.LookupScript(recipient_script, /*after=*/nullptr, 1000, received));
+    BOOST_REQUIRE_EQUAL(received.size(), 1U);
+    BOOST_CHECK(!received[0].spending);
+    BOOST_CHECK_EQUAL(received[0].height, height);
+    BOOST_CHECK_EQUAL(received[0].tx_pos, 1U);
+    BOOST_CHECK(received[0].txid == spend.GetHash());
+    BOOST_CHECK_EQUAL(received[0].amount, 1 * COIN);
+
+    // The coinbase script now has the new block's coinbase and the spend as its last entries.
+    const AddressIndexEntry last_coinbase{entries.back()};
+    entries.clear();
+    BOOST_CHECK(address_index.LookupScript(coinbase_script, &last_coinbase, 1000, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 2U);
+    BOOST_CHECK(!entries[0].spending);
+    BOOST_CHECK(entries[0].txid == block.vtx[0]->GetHash());
+    BOOST_CHECK(entries[1].spending);
+    BOOST_CHECK_EQUAL(entries[1].height, height);
+    BOOST_CHECK(entries[1].txid == spend.GetHash());
+    BOOST_CHECK_EQUAL(entries[1].amount, m_coinbase_txns[0]->vout.at(0).nValue);
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification. The BlockUntilSyncedToCurrentChain()
+    // call above is sufficient to ensure this, but the
+    // SyncWithValidationInterfaceQueue() call below is also needed to ensure
+    // TSAN always sees the test thread waiting for the notification thread, and
+    // avoid potential false positive reports.
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    address_index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -268,6 +268,47 @@ BOOST_FIXTURE_TEST_CASE(blockfilter_index_initial_sync, BuildChainTestingSetup)
     filter_index.Stop();
 }
 
+BOOST_FIXTURE_TEST_CASE(blockfilter_index_sync_read_ahead, BuildChainTestingSetup)
+{
+    // Blocks are read from disk in batches ahead of being indexed, so sync across several
+    // batches, and across a reorg that happened while the index was not running.
+    {
+        BlockFilterIndex filter_index(interfaces::MakeChain(m_node), BlockFilterType::BASIC, 1 << 20, /*f_memory=*/false, /*f_wipe=*/true);
+        BOOST_REQUIRE(filter_index.Init());
+        filter_index.Sync();
+        BOOST_CHECK(filter_index.BlockUntilSyncedToCurrentChain());
+        filter_index.Interrupt();
+        filter_index.Stop();
+    }
+
+    // Stay below the regtest halving height, as BuildChain's coinbases claim the full subsidy.
+    const CBlockIndex* fork_point{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain()[60])};
+    const CScript coinbase_script_pub_key{GetScriptForDestination(PKHash(GenerateRandomKey().GetPubKey()))};
+    std::vector<std::shared_ptr<CBlock>> chain;
+    BOOST_REQUIRE(BuildChain(fork_point, coinbase_script_pub_key, 80, chain));
+    for (const auto& block : chain) {
+        BOOST_REQUIRE(Assert(m_node.chainman)->ProcessNewBlock(block, true, true, nullptr));
+    }
+    BOOST_REQUIRE_EQUAL(WITH_LOCK(cs_main, return m_node.chainman->ActiveHeight()), 140);
+
+    // The index rewinds from the stale tip to the fork point and indexes the new chain.
+    BlockFilterIndex filter_index(interfaces::MakeChain(m_node), BlockFilterType::BASIC, 1 << 20, /*f_memory=*/false, /*f_wipe=*/false);
+    BOOST_REQUIRE(filter_index.Init());
+    filter_index.Sync();
+    BOOST_CHECK(filter_index.BlockUntilSyncedToCurrentChain());
+    {
+        LOCK(cs_main);
+        uint256 last_header;
+        for (const CBlockIndex* block_index = m_node.chainman->ActiveChain().Genesis();
+             block_index != nullptr;
+             block_index = m_node.chainman->ActiveChain().Next(block_index)) {
+            CheckFilterLookups(filter_index, block_index, last_header, m_node.chainman->m_blockman);
+        }
+    }
+    filter_index.Interrupt();
+    filter_index.Stop();
+}
+
 BOOST_FIXTURE_TEST_CASE(blockfilter_index_init_destroy, BasicTestingSetup)
 {
     BlockFilterIndex* filter_index;
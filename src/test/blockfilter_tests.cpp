@@ -41,6 +41,47 @@ BOOST_AUTO_TEST_CASE(gcsfilter_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(gcsfilter_match_any_many)
+{
+    // Filters with different keys and contents, including an empty one.
+    std::vector<GCSFilter> filters;
+    for (uint64_t k0 = 0; k0 < 8; ++k0) {
+        GCSFilter::ElementSet elements;
+        for (int i = 0; i < int(k0) * 10; ++i) {
+            GCSFilter::Element element(32);
+            element[0] = i;
+            element[1] = k0;
+            elements.insert(std::move(element));
+        }
+        filters.emplace_back(GCSFilter::Params{k0, ~k0, 10, 1 << 10}, elements);
+    }
+    std::vector<const GCSFilter*> filter_ptrs;
+    for (const GCSFilter& filter : filters) filter_ptrs.push_back(&filter);
+
+    // A query hitting filters 3 and 5 only (barring false positives, which MatchAny shares).
+    GCSFilter::ElementSet query;
+    for (int i = 0; i < 5; ++i) {
+        GCSFilter::Element element(32);
+        element[0] = i;
+        element[1] = 3 + 2 * (i % 2);
+        query.insert(std::move(element));
+    }
+
+    const std::vector<bool> matches = GCSFilter::MatchAnyMany(filter_ptrs, query);
+    BOOST_REQUIRE_EQUAL(matches.size(), filters.size());
+    for (size_t i = 0; i < filters.size(); ++i) {
+        BOOST_CHECK_EQUAL(matches[i], filters[i].MatchAny(query));
+    }
+    BOOST_CHECK(!matches[0]);
+    BOOST_CHECK(matches[3]);
+    BOOST_CHECK(matches[5]);
+
+    BOOST_CHECK(GCSFilter::MatchAnyMany({}, query).empty());
+    for (bool match : GCSFilter::MatchAnyMany(filter_ptrs, {})) {
+        BOOST_CHECK(!match);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(gcsfilter_default_constructor)
 {
     GCSFilter filter;
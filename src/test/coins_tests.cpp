@@ -1060,6 +1060,33 @@ BOOST_FIXTURE_TEST_CASE(ccoins_flush_behavior, FlushTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(ccoins_db_cursor_start)
+{
+    CCoinsViewDB base{{.path = "test", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+    CCoinsViewCache cache{&base};
+    cache.SetBestBlock(m_rng.rand256());
+    std::vector<COutPoint> outpoints;
+    for (int i = 0; i < 100; ++i) {
+        outpoints.emplace_back(Txid::FromUint256(m_rng.rand256()), m_rng.randrange(3));
+        cache.AddCoin(outpoints.back(), Coin{CTxOut{1, CScript{} << OP_TRUE}, 1, false}, /*possible_overwrite=*/false);
+    }
+    BOOST_REQUIRE(cache.Flush());
+
+    // A cursor positioned at an outpoint yields exactly the coins at or after it.
+    std::sort(outpoints.begin(), outpoints.end());
+    for (size_t skip : {size_t{0}, size_t{1}, size_t{37}, outpoints.size() - 1}) {
+        std::unique_ptr<CCoinsViewCursor> cursor{base.Cursor(outpoints[skip])};
+        for (size_t i = skip; i < outpoints.size(); ++i) {
+            COutPoint key;
+            BOOST_REQUIRE(cursor->Valid());
+            BOOST_REQUIRE(cursor->GetKey(key));
+            BOOST_CHECK(key == outpoints[i]);
+            cursor->Next();
+        }
+        BOOST_CHECK(!cursor->Valid());
+    }
+}
+
 BOOST_AUTO_TEST_CASE(coins_resource_is_used)
 {
     CCoinsMapMemoryResource resource;
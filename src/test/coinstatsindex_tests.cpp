@@ -3,11 +3,13 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <chainparams.h>
+#include <coins.h>
 #include <index/coinstatsindex.h>
 #include <interfaces/chain.h>
 #include <kernel/coinstats.h>
 #include <test/util/setup_common.h>
 #include <test/util/validation.h>
+#include <txdb.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
@@ -114,4 +116,27 @@ BOOST_FIXTURE_TEST_CASE(coinstatsindex_unclean_shutdown, TestChain100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(coinstats_parallel_matches_serial, TestChain100Setup)
+{
+    Chainstate& chainstate{m_node.chainman->ActiveChainstate()};
+    chainstate.ForceFlushStateToDisk();
+    CCoinsViewDB& coins_db{*WITH_LOCK(::cs_main, return &chainstate.CoinsDB())};
+    // Only a CCoinsViewDB is read in parallel txid ranges; the same coins behind
+    // another view are read with a single cursor.
+    CCoinsViewBacked serial_view{&coins_db};
+
+    for (const auto hash_type : {kernel::CoinStatsHashType::HASH_SERIALIZED, kernel::CoinStatsHashType::MUHASH, kernel::CoinStatsHashType::NONE}) {
+        const auto parallel{kernel::ComputeUTXOStats(hash_type, &coins_db, m_node.chainman->m_blockman)};
+        const auto serial{kernel::ComputeUTXOStats(hash_type, &serial_view, m_node.chainman->m_blockman)};
+        BOOST_REQUIRE(parallel && serial);
+        BOOST_CHECK_EQUAL(parallel->hashSerialized, serial->hashSerialized);
+        BOOST_CHECK_EQUAL(parallel->nTransactions, serial->nTransactions);
+        BOOST_CHECK_EQUAL(parallel->nTransactionOutputs, serial->nTransactionOutputs);
+        BOOST_CHECK_EQUAL(parallel->nBogoSize, serial->nBogoSize);
+        BOOST_CHECK_EQUAL(parallel->coins_count, serial->coins_count);
+        BOOST_CHECK(parallel->total_amount == serial->total_amount);
+        BOOST_CHECK_EQUAL(parallel->nTransactions, m_coinbase_txns.size());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
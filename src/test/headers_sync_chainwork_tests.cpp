@@ -143,4 +143,32 @@ BOOST_AUTO_TEST_CASE(headers_sync_state)
     BOOST_CHECK(result.success);
 }
 
+// Check that the parallel proof-of-work check of a batch of headers agrees
+// with the serial one, both for valid batches and for a batch containing a
+// single header with invalid proof of work.
+BOOST_AUTO_TEST_CASE(headers_pow_check_parallel)
+{
+    ChainstateManager& chainman{*Assert(m_node.chainman)};
+    const auto& consensus{Params().GetConsensus()};
+
+    std::vector<CBlockHeader> headers;
+    GenerateHeaders(headers, 2000, Params().GenesisBlock().GetHash(),
+            Params().GenesisBlock().nVersion, Params().GenesisBlock().nTime,
+            ArithToUint256(0), Params().GenesisBlock().nBits);
+
+    // Batches below and above the parallelization threshold
+    const std::vector<CBlockHeader> small_batch(headers.begin(), headers.begin() + HEADER_CHECK_BATCH_SIZE);
+    BOOST_CHECK(chainman.CheckHeadersProofOfWork(small_batch));
+    BOOST_CHECK(chainman.CheckHeadersProofOfWork(headers));
+    BOOST_CHECK(HasValidProofOfWork(headers, consensus));
+
+    // Break the proof of work of a single header in the middle of the batch
+    CBlockHeader& bad_header{headers[1337]};
+    do {
+        ++bad_header.nNonce;
+    } while (CheckProofOfWork(bad_header.GetHash(), bad_header.nBits, consensus));
+    BOOST_CHECK(!HasValidProofOfWork(headers, consensus));
+    BOOST_CHECK(!chainman.CheckHeadersProofOfWork(headers));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -312,6 +312,25 @@ BOOST_AUTO_TEST_CASE(bitstream_reader_writer)
     BOOST_CHECK_EQUAL(bit_reader.Read(7), 7U);
     BOOST_CHECK_EQUAL(bit_reader.Read(16), 30497U);
     BOOST_CHECK_THROW(bit_reader.Read(8), std::ios_base::failure);
+
+    // Unary runs starting mid-byte, spanning byte boundaries, and of length zero.
+    DataStream unary_data{};
+    BitStreamWriter unary_writer{unary_data};
+    for (const int run : {0, 3, 12, 0, 7, 8, 20}) {
+        unary_writer.Write(~0ULL, run);
+        unary_writer.Write(0, 1);
+    }
+    unary_writer.Write(5, 3);
+    unary_writer.Flush();
+
+    BitStreamReader unary_reader{unary_data};
+    for (const uint64_t run : {0, 3, 12, 0, 7, 8, 20}) {
+        BOOST_CHECK_EQUAL(unary_reader.ReadUnary(), run);
+    }
+    BOOST_CHECK_EQUAL(unary_reader.Read(3), 5U);
+    // 57 unary bits and 3 value bits leave 4 bits of padding in the last byte.
+    BOOST_CHECK_EQUAL(unary_reader.Read(4), 0U);
+    BOOST_CHECK_THROW(unary_reader.ReadUnary(), std::ios_base::failure);
 }
 
 BOOST_AUTO_TEST_CASE(streams_serializedata_xor)
@@ -338,4 +338,50 @@ BOOST_FIXTURE_TEST_CASE(handle_missing_inputs, TestChain100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(tx_announcement_batch, TestChain100Setup)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    FastRandomContext det_rand{true};
+    node::TxDownloadOptions DEFAULT_OPTS{pool, det_rand, true};
+    const NodeId nodeid{0};
+    const std::chrono::microseconds now{GetTime()};
+    node::TxDownloadConnectionInfo connection_info{/*m_preferred=*/true, /*m_relay_permissions=*/false, /*m_wtxid_relay=*/true};
+
+    node::TxDownloadManagerImpl txdownload_impl{DEFAULT_OPTS};
+    txdownload_impl.ConnectedPeer(nodeid, connection_info);
+
+    // A transaction we rejected before is dropped, new ones are added once each, in order.
+    const auto ptx_rejected{CreatePlaceholderTx(/*segwit=*/true)};
+    TxValidationState state;
+    state.Invalid(TxValidationResult::TX_CONSENSUS, "");
+    txdownload_impl.MempoolRejectedTx(ptx_rejected, state, nodeid, /*first_time_failure=*/true);
+    const auto ptx_a{CreatePlaceholderTx(/*segwit=*/true)};
+    const auto ptx_b{CreatePlaceholderTx(/*segwit=*/true)};
+
+    const std::vector<GenTxid> gtxids{ptx_rejected->GetWitnessHash(), ptx_a->GetWitnessHash(), ptx_b->GetWitnessHash(), ptx_a->GetWitnessHash()};
+    const std::vector<bool> already_have{txdownload_impl.AddTxAnnouncements(nodeid, gtxids, now)};
+    BOOST_CHECK(already_have == std::vector<bool>({true, false, false, false}));
+    BOOST_CHECK_EQUAL(txdownload_impl.m_txrequest.Count(nodeid), 2U);
+
+    const auto requests{txdownload_impl.GetRequestsToSend(nodeid, now)};
+    BOOST_REQUIRE_EQUAL(requests.size(), 2U);
+    BOOST_CHECK(requests[0] == GenTxid{ptx_a->GetWitnessHash()});
+    BOOST_CHECK(requests[1] == GenTxid{ptx_b->GetWitnessHash()});
+
+    // Batches larger than MAX_ANNOUNCEMENTS_PER_MEMPOOL_LOCK are looked up in several chunks,
+    // with the same result for every announcement.
+    const NodeId nodeid_large{1};
+    txdownload_impl.ConnectedPeer(nodeid_large, connection_info);
+    std::vector<GenTxid> large_batch;
+    for (size_t i{0}; i < 2 * node::MAX_ANNOUNCEMENTS_PER_MEMPOOL_LOCK; ++i) {
+        large_batch.emplace_back(Wtxid::FromUint256(det_rand.rand256()));
+    }
+    large_batch.emplace_back(ptx_rejected->GetWitnessHash());
+    const std::vector<bool> large_already_have{txdownload_impl.AddTxAnnouncements(nodeid_large, large_batch, now)};
+    BOOST_REQUIRE_EQUAL(large_already_have.size(), large_batch.size());
+    BOOST_CHECK(large_already_have.back());
+    BOOST_CHECK_EQUAL(std::count(large_already_have.begin(), large_already_have.end(), true), 1);
+    BOOST_CHECK_EQUAL(txdownload_impl.m_txrequest.Count(nodeid_large), 2 * node::MAX_ANNOUNCEMENTS_PER_MEMPOOL_LOCK);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,10 @@
 
 #include <addresstype.h>
 #include <chainparams.h>
+#include <common/args.h>
+#include <crypto/common.h>
+#include <dbwrapper.h>
+#include <index/disktxpos.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
 #include <test/util/setup_common.h>
@@ -73,4 +77,121 @@ BOOST_FIXTURE_TEST_CASE(txindex_initial_sync, TestChain100Setup)
     txindex.Stop();
 }
 
+//! Key of a compact txindex entry, laid out like TxIndex's: ['T', 8-byte txid prefix, position].
+static std::pair<uint8_t, std::pair<uint64_t, CDiskTxPos>> CompactKey(const uint256& txid, const CDiskTxPos& pos)
+{
+    return {uint8_t{'T'}, {ReadLE64(txid.begin()), pos}};
+}
+
+BOOST_FIXTURE_TEST_CASE(txindex_compact_keys, TestChain100Setup)
+{
+    {
+        TxIndex txindex(interfaces::MakeChain(m_node), 1 << 20, /*f_memory=*/false, /*f_wipe=*/true);
+        BOOST_REQUIRE(txindex.Init());
+        txindex.Sync();
+        txindex.Stop();
+    }
+
+    // Position of the coinbase transaction of the block at the given height, the only
+    // transaction in the blocks of TestChain100Setup.
+    const auto coinbase_pos{[&](int height) {
+        LOCK(cs_main);
+        return CDiskTxPos{m_node.chainman->ActiveChain()[height]->GetBlockPos(), GetSizeOfCompactSize(1)};
+    }};
+    const CTransactionRef& tx_a{m_coinbase_txns[10]};
+    const CTransactionRef& tx_b{m_coinbase_txns[20]};
+    const CTransactionRef& tx_legacy{m_coinbase_txns[30]};
+
+    // A transaction that shares its key prefix with tx_b, but is not indexed.
+    uint256 txid_b_collision{tx_b->GetHash().ToUint256()};
+    *(txid_b_collision.end() - 1) ^= 1;
+
+    {
+        CDBWrapper db{DBParams{.path = gArgs.GetDataDirNet() / "indexes" / "txindex", .cache_bytes = 1 << 20}};
+        // An entry under tx_a's prefix pointing to another transaction, as a prefix collision
+        // would produce.
+        BOOST_REQUIRE(db.Write(CompactKey(tx_a->GetHash(), coinbase_pos(21)), uint8_t{0}));
+        // An entry under tx_a's prefix that sorts before the real one and can't be read.
+        BOOST_REQUIRE(db.Write(CompactKey(tx_a->GetHash(), CDiskTxPos{FlatFilePos{0, 0}, 1 << 30}), uint8_t{0}));
+        // An index entry written by an earlier version under the full txid.
+        BOOST_REQUIRE(db.Erase(CompactKey(tx_legacy->GetHash(), coinbase_pos(31))));
+        BOOST_REQUIRE(db.Write(std::make_pair(uint8_t{'t'}, tx_legacy->GetHash().ToUint256()), coinbase_pos(31)));
+    }
+
+    TxIndex txindex(interfaces::MakeChain(m_node), 1 << 20, /*f_memory=*/false, /*f_wipe=*/false);
+    BOOST_REQUIRE(txindex.Init());
+    txindex.Sync();
+
+    uint256 block_hash;
+    CTransactionRef tx_disk;
+    BOOST_REQUIRE(txindex.FindTx(tx_a->GetHash(), block_hash, tx_disk));
+    BOOST_CHECK_EQUAL(tx_disk->GetHash(), tx_a->GetHash());
+    BOOST_CHECK_EQUAL(block_hash, WITH_LOCK(cs_main, return m_node.chainman->ActiveChain()[11]->GetBlockHash()));
+
+    BOOST_REQUIRE(txindex.FindTx(tx_b->GetHash(), block_hash, tx_disk));
+    BOOST_CHECK_EQUAL(tx_disk->GetHash(), tx_b->GetHash());
+    BOOST_CHECK(!txindex.FindTx(txid_b_collision, block_hash, tx_disk));
+
+    BOOST_REQUIRE(txindex.FindTx(tx_legacy->GetHash(), block_hash, tx_disk));
+    BOOST_CHECK_EQUAL(tx_disk->GetHash(), tx_legacy->GetHash());
+    BOOST_CHECK_EQUAL(block_hash, WITH_LOCK(cs_main, return m_node.chainman->ActiveChain()[31]->GetBlockHash()));
+    txindex.Stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(txindex_version, TestChain100Setup)
+{
+    const fs::path path{gArgs.GetDataDirNet() / "indexes" / "txindex"};
+    {
+        TxIndex txindex(interfaces::MakeChain(m_node), 1 << 20, /*f_memory=*/false, /*f_wipe=*/true);
+        BOOST_REQUIRE(txindex.Init());
+        txindex.Stop();
+    }
+    {
+        CDBWrapper db{DBParams{.path = path, .cache_bytes = 1 << 20}};
+        uint32_t version;
+        BOOST_REQUIRE(db.Read(uint8_t{'V'}, version));
+        BOOST_CHECK_EQUAL(version, 1U);
+        // Pretend a newer version wrote the index.
+        BOOST_REQUIRE(db.Write(uint8_t{'V'}, uint32_t{2}));
+    }
+    TxIndex txindex(interfaces::MakeChain(m_node), 1 << 20, /*f_memory=*/false, /*f_wipe=*/false);
+    BOOST_CHECK(!txindex.Init());
+}
+
+BOOST_FIXTURE_TEST_CASE(txindex_reorg, TestChain100Setup)
+{
+    TxIndex txindex(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(txindex.Init());
+    txindex.Sync();
+
+    const CScript coinbase_script_pub_key{GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()))};
+    const CMutableTransaction tx{CreateValidMempoolTransaction(m_coinbase_txns[0], /*input_vout=*/0, /*input_height=*/1,
+                                                               coinbaseKey, coinbase_script_pub_key, /*output_amount=*/CAmount(49 * COIN),
+                                                               /*submit=*/false)};
+    const Txid txid{tx.GetHash()};
+
+    // Mine the transaction, then replace that block with another one that includes it too.
+    const CBlock stale_block{CreateAndProcessBlock({tx}, coinbase_script_pub_key)};
+    BOOST_CHECK(txindex.BlockUntilSyncedToCurrentChain());
+    BlockValidationState state;
+    BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip())));
+    // Give the replacement block a different coinbase, so that it has a different hash.
+    const CBlock active_block{CreateAndProcessBlock({tx}, CScript{} << OP_TRUE)};
+    BOOST_REQUIRE(active_block.GetHash() != stale_block.GetHash());
+    BOOST_CHECK(txindex.BlockUntilSyncedToCurrentChain());
+
+    // The copy in the active chain is returned, even though the stale one was written first.
+    uint256 block_hash;
+    CTransactionRef tx_disk;
+    BOOST_REQUIRE(txindex.FindTx(txid, block_hash, tx_disk));
+    BOOST_CHECK_EQUAL(tx_disk->GetHash(), txid);
+    BOOST_CHECK_EQUAL(block_hash, active_block.GetHash());
+
+    // The entries of the stale block were removed when it was disconnected.
+    BOOST_CHECK(!txindex.FindTx(stale_block.vtx[0]->GetHash(), block_hash, tx_disk));
+
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    txindex.Stop();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
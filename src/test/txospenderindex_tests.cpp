@@ -0,0 +1,74 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <chain.h>
+#include <consensus/validation.h>
+#include <index/txospenderindex.h>
+#include <interfaces/chain.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(txospenderindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(txospenderindex_spend_and_reorg, TestChain100Setup)
+{
+    TxoSpenderIndex spender_index(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(spender_index.Init());
+    spender_index.Sync();
+
+    const COutPoint spent_prevout{m_coinbase_txns[0]->GetHash(), 0};
+    const COutPoint unspent_prevout{m_coinbase_txns[1]->GetHash(), 0};
+    BOOST_CHECK(!spender_index.FindSpender(spent_prevout));
+
+    // Spend the first coinbase in a new block.
+    const CScript coinbase_script{m_coinbase_txns[0]->vout.at(0).scriptPubKey};
+    const CScript recipient_script{GetScriptForDestination(WitnessV0KeyHash(GenerateRandomKey().GetPubKey()))};
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[0], /*input_vout=*/0, /*input_height=*/0,
+                                                                  coinbaseKey, recipient_script, /*output_amount=*/1 * COIN, /*submit=*/false)};
+    CreateAndProcessBlock({spend}, coinbase_script);
+    BOOST_CHECK(spender_index.BlockUntilSyncedToCurrentChain());
+    const int spend_height{WITH_LOCK(::cs_main, return m_node.chainman->ActiveHeight())};
+
+    const auto spender{spender_index.FindSpender(spent_prevout)};
+    BOOST_REQUIRE(spender);
+    BOOST_CHECK(spender->txid == spend.GetHash());
+    BOOST_CHECK_EQUAL(spender->height, spend_height);
+    BOOST_CHECK(!spender_index.FindSpender(unspent_prevout));
+
+    // Batch lookups return one result per prevout, in order.
+    const std::vector<COutPoint> prevouts{unspent_prevout, spent_prevout, unspent_prevout};
+    const auto spenders{spender_index.FindSpenders(prevouts)};
+    BOOST_REQUIRE_EQUAL(spenders.size(), prevouts.size());
+    BOOST_CHECK(!spenders[0]);
+    BOOST_REQUIRE(spenders[1]);
+    BOOST_CHECK(spenders[1]->txid == spend.GetHash());
+    BOOST_CHECK(!spenders[2]);
+
+    // Reorganize the spend out, replacing its block with an empty one. The
+    // index rewinds to the fork point and the entry is erased.
+    {
+        BlockValidationState state;
+        CBlockIndex* tip{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, tip));
+    }
+    CreateAndProcessBlock({}, coinbase_script);
+    BOOST_CHECK(spender_index.BlockUntilSyncedToCurrentChain());
+    BOOST_CHECK(!spender_index.FindSpender(spent_prevout));
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification. The BlockUntilSyncedToCurrentChain()
+    // call above is sufficient to ensure this, but the
+    // SyncWithValidationInterfaceQueue() call below is also needed to ensure
+    // TSAN always sees the test thread waiting for the notification thread, and
+    // avoid potential false positive reports.
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    spender_index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,8 +4,11 @@
 
 #include <node/txreconciliation.h>
 
+#include <random.h>
 #include <test/util/setup_common.h>
 
+#include <set>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_FIXTURE_TEST_SUITE(txreconciliation_tests, BasicTestingSetup)
@@ -81,4 +84,169 @@ BOOST_AUTO_TEST_CASE(IsPeerRegisteredTest)
     BOOST_CHECK(!tracker.IsPeerRegistered(peer_id0));
 }
 
+BOOST_AUTO_TEST_CASE(AddToSetTest)
+{
+    TxReconciliationTracker tracker(TXRECONCILIATION_VERSION);
+    NodeId peer_id0 = 0;
+    FastRandomContext frc{/*fDeterministic=*/true};
+
+    Wtxid wtxid{Wtxid::FromUint256(frc.rand256())};
+
+    // Unregistered peers have no set.
+    BOOST_REQUIRE(!tracker.IsPeerRegistered(peer_id0));
+    BOOST_CHECK(!tracker.AddToSet(peer_id0, wtxid));
+
+    tracker.PreRegisterPeer(peer_id0);
+    BOOST_REQUIRE_EQUAL(tracker.RegisterPeer(peer_id0, true, 1, 1), ReconciliationRegisterResult::SUCCESS);
+
+    BOOST_CHECK(tracker.AddToSet(peer_id0, wtxid));
+    // Adding the same transaction twice fails.
+    BOOST_CHECK(!tracker.AddToSet(peer_id0, wtxid));
+    BOOST_CHECK_EQUAL(tracker.GetSetSize(peer_id0), 1U);
+
+    BOOST_CHECK(tracker.TryRemovingFromSet(peer_id0, wtxid));
+    BOOST_CHECK(!tracker.TryRemovingFromSet(peer_id0, wtxid));
+    BOOST_CHECK_EQUAL(tracker.GetSetSize(peer_id0), 0U);
+
+    // The set is bounded.
+    for (size_t i = 0; i < MAX_RECONSET_SIZE; ++i) {
+        BOOST_REQUIRE(tracker.AddToSet(peer_id0, Wtxid::FromUint256(frc.rand256())));
+    }
+    BOOST_CHECK(!tracker.AddToSet(peer_id0, Wtxid::FromUint256(frc.rand256())));
+    BOOST_CHECK_EQUAL(tracker.GetSetSize(peer_id0), MAX_RECONSET_SIZE);
+
+    tracker.ForgetPeer(peer_id0);
+    BOOST_CHECK_EQUAL(tracker.GetSetSize(peer_id0), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(ReconcileTest)
+{
+    // Two nodes, each seeing the other as peer 0, with the same full salt.
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    NodeId peer_id0 = 0;
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(peer_id0)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(peer_id0)};
+    BOOST_REQUIRE_EQUAL(initiator.RegisterPeer(peer_id0, false, 1, responder_salt), ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE_EQUAL(responder.RegisterPeer(peer_id0, true, 1, initiator_salt), ReconciliationRegisterResult::SUCCESS);
+
+    FastRandomContext frc{/*fDeterministic=*/true};
+    std::set<Wtxid> initiator_only, responder_only;
+    for (int i = 0; i < 100; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(frc.rand256())};
+        BOOST_REQUIRE(initiator.AddToSet(peer_id0, wtxid));
+        BOOST_REQUIRE(responder.AddToSet(peer_id0, wtxid));
+    }
+    for (int i = 0; i < 5; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(frc.rand256())};
+        BOOST_REQUIRE(initiator.AddToSet(peer_id0, wtxid));
+        initiator_only.insert(wtxid);
+    }
+    for (int i = 0; i < 3; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(frc.rand256())};
+        BOOST_REQUIRE(responder.AddToSet(peer_id0, wtxid));
+        responder_only.insert(wtxid);
+    }
+
+    const uint32_t capacity{TxReconciliationTracker::EstimateSketchCapacity(initiator.GetSetSize(peer_id0), responder.GetSetSize(peer_id0))};
+    BOOST_CHECK_EQUAL(capacity, 2 + 26 + 1);
+    BOOST_CHECK(responder.GetSketch(peer_id0, /*capacity=*/0).empty());
+    BOOST_CHECK(responder.GetSketch(peer_id0, MAX_SKETCH_CAPACITY + 1).empty());
+    const std::vector<uint8_t> sketch{responder.GetSketch(peer_id0, capacity)};
+    BOOST_CHECK_EQUAL(sketch.size(), capacity * 4);
+    // The cached sketch is returned for repeated requests.
+    BOOST_CHECK(responder.GetSketch(peer_id0, capacity) == sketch);
+
+    // Sketches we didn't ask for are rejected.
+    BOOST_CHECK(!initiator.ReconcileWithSketch(peer_id0, sketch));
+    BOOST_REQUIRE(initiator.InitiateReconciliationRequest(peer_id0));
+    // Only one request can be outstanding, and only the initiator sends them.
+    BOOST_CHECK(!initiator.InitiateReconciliationRequest(peer_id0));
+    BOOST_CHECK(!responder.InitiateReconciliationRequest(peer_id0));
+
+    // Malformed sketches are rejected without touching the set.
+    BOOST_CHECK(!initiator.ReconcileWithSketch(peer_id0, std::span{sketch}.first(3)));
+    BOOST_CHECK(!initiator.ReconcileWithSketch(peer_id0, {}));
+    BOOST_CHECK_EQUAL(initiator.GetSetSize(peer_id0), 105U);
+
+    const auto result{initiator.ReconcileWithSketch(peer_id0, sketch)};
+    BOOST_REQUIRE(result);
+    BOOST_CHECK(result->success);
+    BOOST_CHECK(std::set<Wtxid>(result->announce.begin(), result->announce.end()) == initiator_only);
+    BOOST_CHECK_EQUAL(result->request.size(), responder_only.size());
+    BOOST_CHECK_EQUAL(initiator.GetSetSize(peer_id0), 0U);
+
+    // A difference larger than the capacity can't be decoded, and the whole set is returned.
+    // A sketch of capacity 1 always decodes to some element, so use a larger one.
+    for (int i = 0; i < 10; ++i) {
+        BOOST_REQUIRE(initiator.AddToSet(peer_id0, Wtxid::FromUint256(frc.rand256())));
+    }
+    BOOST_REQUIRE(initiator.InitiateReconciliationRequest(peer_id0));
+    const auto failed_result{initiator.ReconcileWithSketch(peer_id0, responder.GetSketch(peer_id0, /*capacity=*/8))};
+    BOOST_REQUIRE(failed_result);
+    BOOST_CHECK(!failed_result->success);
+    BOOST_CHECK_EQUAL(failed_result->announce.size(), 10U);
+    BOOST_CHECK(failed_result->request.empty());
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationRoundTest)
+{
+    // A full round through the message handlers: reqrecon, sketch and reconcildiff.
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    NodeId peer_id0 = 0;
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(peer_id0)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(peer_id0)};
+    BOOST_REQUIRE_EQUAL(initiator.RegisterPeer(peer_id0, false, 1, responder_salt), ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE_EQUAL(responder.RegisterPeer(peer_id0, true, 1, initiator_salt), ReconciliationRegisterResult::SUCCESS);
+
+    FastRandomContext frc{/*fDeterministic=*/true};
+    std::set<Wtxid> responder_only;
+    for (int i = 0; i < 50; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(frc.rand256())};
+        BOOST_REQUIRE(initiator.AddToSet(peer_id0, wtxid));
+        BOOST_REQUIRE(responder.AddToSet(peer_id0, wtxid));
+    }
+    for (int i = 0; i < 4; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(frc.rand256())};
+        BOOST_REQUIRE(responder.AddToSet(peer_id0, wtxid));
+        responder_only.insert(wtxid);
+    }
+
+    // Differences are only accepted after sending a sketch, and only the responder sends one.
+    BOOST_CHECK(!responder.HandleReconciliationDifference(peer_id0, true, {}));
+    const auto request{initiator.InitiateReconciliationRequest(peer_id0)};
+    BOOST_REQUIRE(request);
+    BOOST_CHECK_EQUAL(request->first, 50);
+    BOOST_CHECK(!initiator.HandleReconciliationRequest(peer_id0, request->first, request->second));
+    const auto sketch{responder.HandleReconciliationRequest(peer_id0, request->first, request->second)};
+    BOOST_REQUIRE(sketch);
+    BOOST_CHECK_EQUAL(sketch->size(), TxReconciliationTracker::EstimateSketchCapacity(54, 50) * 4);
+    // The sketched set is set aside: new transactions go to the next round, and a second
+    // request before the difference arrives is a protocol violation.
+    BOOST_CHECK_EQUAL(responder.GetSetSize(peer_id0), 0U);
+    const Wtxid next_round{Wtxid::FromUint256(frc.rand256())};
+    BOOST_REQUIRE(responder.AddToSet(peer_id0, next_round));
+    BOOST_CHECK(!responder.HandleReconciliationRequest(peer_id0, request->first, request->second));
+
+    const auto result{initiator.ReconcileWithSketch(peer_id0, *sketch)};
+    BOOST_REQUIRE(result);
+    BOOST_REQUIRE(result->success);
+    BOOST_CHECK(result->announce.empty());
+    BOOST_CHECK_EQUAL(result->request.size(), responder_only.size());
+
+    const auto announce{responder.HandleReconciliationDifference(peer_id0, result->success, result->request)};
+    BOOST_REQUIRE(announce);
+    BOOST_CHECK(std::set<Wtxid>(announce->begin(), announce->end()) == responder_only);
+    BOOST_CHECK(!responder.HandleReconciliationDifference(peer_id0, true, {}));
+    BOOST_CHECK_EQUAL(responder.GetSetSize(peer_id0), 1U);
+
+    // On failure, the whole sketched set is returned to be flooded.
+    BOOST_REQUIRE(initiator.InitiateReconciliationRequest(peer_id0));
+    BOOST_REQUIRE(responder.HandleReconciliationRequest(peer_id0, 0, 0));
+    const auto flood{responder.HandleReconciliationDifference(peer_id0, false, {})};
+    BOOST_REQUIRE(flood);
+    BOOST_CHECK(*flood == std::vector<Wtxid>{next_round});
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <sync.h>
+#include <util/threadnames.h>
+#include <util/threadpool.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <set>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(util_threadpool_tests)
+
+BOOST_AUTO_TEST_CASE(tasks_run_on_pool_threads)
+{
+    constexpr int NUM_TASKS{100};
+    Mutex mutex;
+    std::condition_variable cond;
+    int done{0};
+    std::set<std::string> names;
+    {
+        util::ThreadPool pool{/*num_threads=*/3, "testpool"};
+        BOOST_CHECK_EQUAL(pool.Size(), 3);
+        for (int i = 0; i < NUM_TASKS; ++i) {
+            pool.Submit([&] {
+                LOCK(mutex);
+                names.insert(util::ThreadGetInternalName());
+                ++done;
+                cond.notify_all();
+            });
+        }
+        WAIT_LOCK(mutex, lock);
+        cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(mutex) { return done == NUM_TASKS; });
+    }
+    BOOST_CHECK(!names.empty());
+    for (const std::string& name : names) {
+        BOOST_CHECK(name == "testpool.0" || name == "testpool.1" || name == "testpool.2");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(destruction_waits_for_running_tasks)
+{
+    Mutex mutex;
+    std::condition_variable cond;
+    bool started{false};
+    bool finished{false};
+    {
+        util::ThreadPool pool{/*num_threads=*/1, "testpool"};
+        pool.Submit([&] {
+            WAIT_LOCK(mutex, lock);
+            started = true;
+            cond.notify_all();
+            cond.wait_for(lock, std::chrono::milliseconds{50});
+            finished = true;
+        });
+        WAIT_LOCK(mutex, lock);
+        cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(mutex) { return started; });
+    }
+    // The pool was destroyed while the task was running, and waited for it.
+    BOOST_CHECK(WITH_LOCK(mutex, return finished));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
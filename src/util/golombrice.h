@@ -32,10 +32,7 @@ template <typename IStream>
 uint64_t GolombRiceDecode(BitStreamReader<IStream>& bitreader, uint8_t P)
 {
     // Read unary-encoded quotient: q 1's followed by one 0.
-    uint64_t q = 0;
-    while (bitreader.Read(1) == 1) {
-        ++q;
-    }
+    uint64_t q = bitreader.ReadUnary();
 
     uint64_t r = bitreader.Read(P);
 
@@ -0,0 +1,54 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/threadpool.h>
+
+#include <tinyformat.h>
+#include <util/threadnames.h>
+
+#include <utility>
+
+namespace util {
+ThreadPool::ThreadPool(int num_threads, const std::string& thread_name)
+{
+    for (int i = 0; i < num_threads; ++i) {
+        m_threads.emplace_back([this, name = strprintf("%s.%i", thread_name, i)] {
+            util::ThreadRename(name);
+            Run();
+        });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        LOCK(m_mutex);
+        m_running = false;
+        m_cond.notify_all();
+    }
+    for (auto& thread : m_threads) thread.join();
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    LOCK(m_mutex);
+    m_tasks.push_back(std::move(task));
+    m_cond.notify_one();
+}
+
+void ThreadPool::Run()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            while (m_running && m_tasks.empty()) m_cond.wait(lock);
+            if (!m_running) break;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+} // namespace util
@@ -0,0 +1,51 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_THREADPOOL_H
+#define BITCOIN_UTIL_THREADPOOL_H
+
+#include <sync.h>
+#include <threadsafety.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace util {
+/**
+ * A fixed number of threads executing submitted tasks in submission order.
+ *
+ * Tasks must not throw. Tasks that have not started when the pool is
+ * destroyed are dropped, so a task must not be the only way its submitter
+ * learns that work is done.
+ */
+class ThreadPool
+{
+public:
+    /** Start num_threads threads, named "<thread_name>.<n>". */
+    ThreadPool(int num_threads, const std::string& thread_name);
+    /** Stop the threads once their current tasks are done. */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> task) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    int Size() const { return m_threads.size(); }
+
+private:
+    Mutex m_mutex;
+    std::condition_variable m_cond GUARDED_BY(m_mutex);
+    std::deque<std::function<void()>> m_tasks GUARDED_BY(m_mutex);
+    bool m_running GUARDED_BY(m_mutex){true};
+    std::vector<std::thread> m_threads;
+
+    void Run() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+} // namespace util
+
+#endif // BITCOIN_UTIL_THREADPOOL_H
@@ -4141,6 +4141,35 @@ bool HasValidProofOfWork(const std::vector<CBlockHeader>& headers, const Consens
             [&](const auto& header) { return CheckProofOfWork(header.GetHash(), header.nBits, consensusParams);});
 }
 
+std::optional<uint256> CHeaderPoWCheck::operator()() const
+{
+    const uint256 hash{m_header->GetHash()};
+    if (!CheckProofOfWork(hash, m_header->nBits, *m_consensus_params)) return hash;
+    return std::nullopt;
+}
+
+bool ChainstateManager::CheckHeadersProofOfWork(const std::vector<CBlockHeader>& headers)
+{
+    // Not worth the synchronization overhead for a handful of headers, such
+    // as a new block announcement.
+    if (!m_header_check_queue.HasThreads() || headers.size() <= HEADER_CHECK_BATCH_SIZE) {
+        return HasValidProofOfWork(headers, GetConsensus());
+    }
+
+    std::vector<CHeaderPoWCheck> checks;
+    checks.reserve(headers.size());
+    for (const CBlockHeader& header : headers) {
+        checks.emplace_back(header, GetConsensus());
+    }
+    CCheckQueueControl<CHeaderPoWCheck> control{m_header_check_queue};
+    control.Add(std::move(checks));
+    if (const auto invalid_hash{control.Complete()}) {
+        LogDebug(BCLog::VALIDATION, "header %s has invalid proof of work\n", invalid_hash->ToString());
+        return false;
+    }
+    return true;
+}
+
 bool IsBlockMutated(const CBlock& block, bool check_witness_root)
 {
     BlockValidationState state;
@@ -6286,6 +6315,8 @@ static ChainstateManager::Options&& Flatten(ChainstateManager::Options&& opts)
 
 ChainstateManager::ChainstateManager(const util::SignalInterrupt& interrupt, Options options, node::BlockManager::Options blockman_options)
     : m_script_check_queue{/*batch_size=*/128, std::clamp(options.worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS)},
+      m_header_check_queue{HEADER_CHECK_BATCH_SIZE, std::clamp(options.worker_threads_num, 0, MAX_HEADERCHECK_THREADS),
+                           "Header verification", "headerch"},
       m_interrupt{interrupt},
       m_options{Flatten(std::move(options))},
       m_blockman{interrupt, std::move(blockman_options)},
@@ -81,6 +81,12 @@ static const uint64_t MIN_DISK_SPACE_FOR_BLOCK_FILES = 550 * 1024 * 1024;
 
 /** Maximum number of dedicated script-checking threads allowed */
 static constexpr int MAX_SCRIPTCHECK_THREADS{15};
+/** Number of header proof-of-work checks a worker thread takes from the queue at once */
+static constexpr unsigned int HEADER_CHECK_BATCH_SIZE{64};
+/** Maximum number of dedicated header-checking threads. A full headers message
+ *  (MAX_HEADERS_RESULTS) only takes a few milliseconds to hash, so a handful
+ *  of workers is enough and the rest of -par is left to script checks. */
+static constexpr int MAX_HEADERCHECK_THREADS{3};
 
 /** Current sync state passed to tip changed callbacks. */
 enum class SynchronizationState {
@@ -356,6 +362,23 @@ static_assert(std::is_nothrow_move_assignable_v<CScriptCheck>);
 static_assert(std::is_nothrow_move_constructible_v<CScriptCheck>);
 static_assert(std::is_nothrow_destructible_v<CScriptCheck>);
 
+/**
+ * Closure representing the proof-of-work check of a single block header.
+ * On failure, returns the hash of the offending header.
+ */
+class CHeaderPoWCheck
+{
+private:
+    const CBlockHeader* m_header;
+    const Consensus::Params* m_consensus_params;
+
+public:
+    CHeaderPoWCheck(const CBlockHeader& header, const Consensus::Params& consensus_params) :
+        m_header(&header), m_consensus_params(&consensus_params) { }
+
+    std::optional<uint256> operator()() const;
+};
+
 /**
  * Convenience class for initializing and passing the script execution cache
  * and signature cache.
@@ -962,6 +985,9 @@ private:
     //! A queue for script verifications that have to be performed by worker threads.
     CCheckQueue<CScriptCheck> m_script_check_queue;
 
+    //! A queue for header proof-of-work checks that have to be performed by worker threads.
+    CCheckQueue<CHeaderPoWCheck> m_header_check_queue;
+
     //! Timers and counters used for benchmarking validation in both background
     //! and active chainstates.
     SteadyClock::duration GUARDED_BY(::cs_main) time_check{};
@@ -1320,6 +1346,13 @@ public:
 
     CCheckQueue<CScriptCheck>& GetCheckQueue() { return m_script_check_queue; }
 
+    /**
+     * Check that the proof of work of each header matches the value in nBits,
+     * like HasValidProofOfWork(). Large batches (e.g. a full headers message)
+     * are hashed in parallel on the header check queue's worker threads.
+     */
+    bool CheckHeadersProofOfWork(const std::vector<CBlockHeader>& headers);
+
     ~ChainstateManager();
 };
 
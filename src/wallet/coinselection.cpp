@@ -609,6 +609,15 @@ static void ApproximateBestSubset(FastRandomContext& insecure_rand, const std::v
     vfBest.assign(groups.size(), true);
     nBest = nTotalLower;
 
+    // Every repetition walks over all groups, so copy the two fields it reads into contiguous
+    // arrays rather than striding over the much larger OutputGroup objects.
+    std::vector<CAmount> amounts(groups.size());
+    std::vector<int> weights(groups.size());
+    for (size_t i = 0; i < groups.size(); ++i) {
+        amounts[i] = groups[i].GetSelectionAmount();
+        weights[i] = groups[i].m_weight;
+    }
+
     for (int nRep = 0; nRep < iterations && nBest != nTargetValue; nRep++)
     {
         vfIncluded.assign(groups.size(), false);
@@ -625,24 +634,23 @@ static void ApproximateBestSubset(FastRandomContext& insecure_rand, const std::v
                 //that the rng is fast. We do not use a constant random sequence,
                 //because there may be some privacy improvement by making
                 //the selection random.
-                if (nPass == 0 ? insecure_rand.randbool() : !vfIncluded[i])
-                {
-                    nTotal += groups[i].GetSelectionAmount();
-                    selected_coins_weight += groups[i].m_weight;
-                    vfIncluded[i] = true;
-                    if (nTotal >= nTargetValue && selected_coins_weight <= max_selection_weight) {
-                        fReachedTarget = true;
-                        // If the total is between nTargetValue and nBest, it's our new best
-                        // approximation.
-                        if (nTotal < nBest)
-                        {
-                            nBest = nTotal;
-                            vfBest = vfIncluded;
-                        }
-                        nTotal -= groups[i].GetSelectionAmount();
-                        selected_coins_weight -= groups[i].m_weight;
-                        vfIncluded[i] = false;
+                const bool include{nPass == 0 ? insecure_rand.randbool() : !vfIncluded[i]};
+                // Add without branching on the random bit, which the CPU cannot predict.
+                nTotal += amounts[i] & -CAmount{include};
+                selected_coins_weight += weights[i] & -int{include};
+                vfIncluded[i] |= include;
+                if (include && nTotal >= nTargetValue && selected_coins_weight <= max_selection_weight) {
+                    fReachedTarget = true;
+                    // If the total is between nTargetValue and nBest, it's our new best
+                    // approximation.
+                    if (nTotal < nBest)
+                    {
+                        nBest = nTotal;
+                        vfBest = vfIncluded;
                     }
+                    nTotal -= amounts[i];
+                    selected_coins_weight -= weights[i];
+                    vfIncluded[i] = false;
                 }
             }
         }
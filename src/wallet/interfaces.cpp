@@ -158,6 +158,11 @@ public:
         LOCK(m_wallet->cs_wallet);
         return m_wallet->GetNewDestination(type, label);
     }
+    util::Result<std::vector<CTxDestination>> getNewDestinations(const OutputType type, const std::string& label, size_t count) override
+    {
+        LOCK(m_wallet->cs_wallet);
+        return m_wallet->GetNewDestinations(type, label, count);
+    }
     bool getPubKey(const CScript& script, const CKeyID& address, CPubKey& pub_key) override
     {
         std::unique_ptr<SigningProvider> provider = m_wallet->GetSolvingProvider(script);
@@ -256,17 +256,17 @@ Balance GetBalance(const CWallet& wallet, const int min_depth, bool avoid_reuse)
     {
         LOCK(wallet.cs_wallet);
         std::set<Txid> trusted_parents;
-        for (const auto& [outpoint, txo] : wallet.GetTXOs()) {
-            const CWalletTx& wtx = txo.GetWalletTx();
+        for (const auto& [outpoint, txo] : wallet.GetUnspentTXOs()) {
+            const CWalletTx& wtx = txo->GetWalletTx();
 
             const bool is_trusted{CachedTxIsTrusted(wallet, wtx, trusted_parents)};
             const int tx_depth{wallet.GetTxDepthInMainChain(wtx)};
 
-            if (!wallet.IsSpent(outpoint) && (allow_used_addresses || !wallet.IsSpentKey(txo.GetTxOut().scriptPubKey))) {
+            if (allow_used_addresses || !wallet.IsSpentKey(txo->GetTxOut().scriptPubKey)) {
                 // Get the amounts for mine
                 CAmount credit_mine = 0;
-                if (txo.GetIsMine() == ISMINE_SPENDABLE) {
-                    credit_mine = txo.GetTxOut().nValue;
+                if (txo->GetIsMine() == ISMINE_SPENDABLE) {
+                    credit_mine = txo->GetTxOut().nValue;
                 } else {
                     // We shouldn't see any other isminetypes
                     Assume(false);
@@ -69,6 +69,76 @@ RPCHelpMan getnewaddress()
     };
 }
 
+//! Maximum number of addresses getnewaddresses derives in one call
+static constexpr int MAX_NEW_ADDRESSES{100000};
+
+RPCHelpMan getnewaddresses()
+{
+    return RPCHelpMan{
+        "getnewaddresses",
+        "Returns new Bitcoin addresses for receiving payments, like calling getnewaddress count times.\n"
+                "The addresses are derived together and written to the wallet in a single database transaction.\n"
+                "If not all of them can be derived, for example from a locked wallet with hardened derivation, none are returned and none are used up.\n"
+                "If 'label' is specified, it is added to the address book for each address.\n",
+                {
+                    {"count", RPCArg::Type::NUM, RPCArg::Optional::NO, "The number of addresses to generate, at most " + util::ToString(MAX_NEW_ADDRESSES) + "."},
+                    {"label", RPCArg::Type::STR, RPCArg::Default{""}, "The label name for the addresses to be linked to. It can also be set to the empty string \"\" to represent the default label. The label does not need to exist, it will be created if there is no label by the given name."},
+                    {"address_type", RPCArg::Type::STR, RPCArg::DefaultHint{"set by -addresstype"}, "The address type to use. Options are " + FormatAllOutputTypes() + "."},
+                },
+                RPCResult{
+                    RPCResult::Type::ARR, "", "",
+                    {
+                        {RPCResult::Type::STR, "address", "A new bitcoin address"},
+                    }
+                },
+                RPCExamples{
+                    HelpExampleCli("getnewaddresses", "100")
+            + HelpExampleCli("getnewaddresses", "100 \"deposits\" bech32m")
+            + HelpExampleRpc("getnewaddresses", "100, \"deposits\"")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    std::shared_ptr<CWallet> const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!pwallet) return UniValue::VNULL;
+
+    LOCK(pwallet->cs_wallet);
+
+    if (!pwallet->CanGetAddresses()) {
+        throw JSONRPCError(RPC_WALLET_ERROR, "Error: This wallet has no available keys");
+    }
+
+    const int count{request.params[0].getInt<int>()};
+    if (count < 1 || count > MAX_NEW_ADDRESSES) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid count, must be between 1 and %d", MAX_NEW_ADDRESSES));
+    }
+
+    // Parse the label first so we don't generate keys if there's an error
+    const std::string label{LabelFromValue(request.params[1])};
+
+    OutputType output_type = pwallet->m_default_address_type;
+    if (!request.params[2].isNull()) {
+        std::optional<OutputType> parsed = ParseOutputType(request.params[2].get_str());
+        if (!parsed) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("Unknown address type '%s'", request.params[2].get_str()));
+        }
+        output_type = parsed.value();
+    }
+
+    auto op_dests = pwallet->GetNewDestinations(output_type, label, count);
+    if (!op_dests) {
+        throw JSONRPCError(RPC_WALLET_KEYPOOL_RAN_OUT, util::ErrorString(op_dests).original);
+    }
+
+    UniValue ret(UniValue::VARR);
+    ret.reserve(op_dests->size());
+    for (const CTxDestination& dest : *op_dests) {
+        ret.push_back(EncodeDestination(dest));
+    }
+    return ret;
+},
+    };
+}
+
 RPCHelpMan getrawchangeaddress()
 {
     return RPCHelpMan{
@@ -304,11 +304,12 @@ static void MaybePushAddress(UniValue & entry, const CTxDestination &dest)
  * @param  ret            The vector into which the result is stored.
  * @param  filter_ismine  The "is mine" filter flags.
  * @param  filter_label   Optional label string to filter incoming transactions.
+ * @param  skip           If not null, the first *skip entries are counted off (decrementing *skip) without being built.
  */
 template <class Vec>
 static void ListTransactions(const CWallet& wallet, const CWalletTx& wtx, int nMinDepth, bool fLong,
                              Vec& ret, const isminefilter& filter_ismine, const std::optional<std::string>& filter_label,
-                             bool include_change = false)
+                             bool include_change = false, size_t* skip = nullptr)
     EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
 {
     CAmount nFee;
@@ -322,6 +323,10 @@ static void ListTransactions(const CWallet& wallet, const CWalletTx& wtx, int nM
     {
         for (const COutputEntry& s : listSent)
         {
+            if (skip && *skip > 0) {
+                --*skip;
+                continue;
+            }
             UniValue entry(UniValue::VOBJ);
             MaybePushAddress(entry, s.destination);
             entry.pushKV("category", "send");
@@ -351,6 +356,10 @@ static void ListTransactions(const CWallet& wallet, const CWalletTx& wtx, int nM
             if (filter_label.has_value() && label != filter_label.value()) {
                 continue;
             }
+            if (skip && *skip > 0) {
+                --*skip;
+                continue;
+            }
             UniValue entry(UniValue::VOBJ);
             MaybePushAddress(entry, r.destination);
             PushParentDescriptors(wallet, wtx.tx->vout.at(r.vout).scriptPubKey, entry);
@@ -497,25 +506,25 @@ RPCHelpMan listtransactions()
 
         const CWallet::TxItems & txOrdered = pwallet->wtxOrdered;
 
-        // iterate backwards until we have nCount items to return:
+        // iterate backwards until we have nCount items to return. The nFrom newer entries are only
+        // counted, so that deep pages do not pay for building the entries they skip.
+        size_t skip = nFrom;
         for (CWallet::TxItems::const_reverse_iterator it = txOrdered.rbegin(); it != txOrdered.rend(); ++it)
         {
             CWalletTx *const pwtx = (*it).second;
-            ListTransactions(*pwallet, *pwtx, 0, true, ret, filter, filter_label);
-            if ((int)ret.size() >= (nCount+nFrom)) break;
+            ListTransactions(*pwallet, *pwtx, 0, true, ret, filter, filter_label, /*include_change=*/false, &skip);
+            if ((int)ret.size() >= nCount) break;
         }
     }
 
-    // ret is newest to oldest
+    // ret is newest to oldest, starting after the skipped entries
 
-    if (nFrom > (int)ret.size())
-        nFrom = ret.size();
-    if ((nFrom + nCount) > (int)ret.size())
-        nCount = ret.size() - nFrom;
+    if (nCount > (int)ret.size())
+        nCount = ret.size();
 
     auto txs_rev_it{std::make_move_iterator(ret.rend())};
     UniValue result{UniValue::VARR};
-    result.push_backV(txs_rev_it - nFrom - nCount, txs_rev_it - nFrom); // Return oldest to newest
+    result.push_backV(txs_rev_it - nCount, txs_rev_it); // Return oldest to newest
     return result;
 },
     };
@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <common/system.h>
 #include <hash.h>
 #include <key_io.h>
 #include <logging.h>
@@ -15,11 +16,18 @@
 #include <util/check.h>
 #include <util/strencodings.h>
 #include <util/string.h>
+#include <util/threadnames.h>
 #include <util/time.h>
 #include <util/translation.h>
 #include <wallet/scriptpubkeyman.h>
 
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <limits>
 #include <optional>
+#include <span>
+#include <thread>
 
 using common::PSBTError;
 using util::ToString;
@@ -834,28 +842,84 @@ util::Result<CTxDestination> DescriptorScriptPubKeyMan::GetNewDestination(const
             throw std::runtime_error(std::string(__func__) + ": Types are inconsistent. Stored type does not match type of newly generated address");
         }
 
-        TopUp();
+        // Write the top up and the new next_index in a single database transaction
+        WalletBatch batch(m_storage.GetDatabase());
+        if (!batch.TxnBegin()) return util::Error{strprintf(_("Error: database transaction cannot be executed for wallet %s"), m_storage.GetDisplayName())};
+        auto get_dest = [&]() EXCLUSIVE_LOCKS_REQUIRED(cs_desc_man) -> util::Result<CTxDestination> {
+            TopUpWithDB(batch);
 
-        // Get the scriptPubKey from the descriptor
-        FlatSigningProvider out_keys;
-        std::vector<CScript> scripts_temp;
-        if (m_wallet_descriptor.range_end <= m_max_cached_index && !TopUp(1)) {
-            // We can't generate anymore keys
-            return util::Error{_("Error: Keypool ran out, please call keypoolrefill first")};
-        }
-        if (!m_wallet_descriptor.descriptor->ExpandFromCache(m_wallet_descriptor.next_index, m_wallet_descriptor.cache, scripts_temp, out_keys)) {
+            // Get the scriptPubKey from the descriptor
+            FlatSigningProvider out_keys;
+            std::vector<CScript> scripts_temp;
+            if (m_wallet_descriptor.range_end <= m_max_cached_index && !TopUpWithDB(batch, 1)) {
+                // We can't generate anymore keys
+                return util::Error{_("Error: Keypool ran out, please call keypoolrefill first")};
+            }
+            if (!m_wallet_descriptor.descriptor->ExpandFromCache(m_wallet_descriptor.next_index, m_wallet_descriptor.cache, scripts_temp, out_keys)) {
+                // We can't generate anymore keys
+                return util::Error{_("Error: Keypool ran out, please call keypoolrefill first")};
+            }
+
+            CTxDestination dest;
+            if (!ExtractDestination(scripts_temp[0], dest)) {
+                return util::Error{_("Error: Cannot extract destination from the generated scriptpubkey")}; // shouldn't happen
+            }
+            m_wallet_descriptor.next_index++;
+            batch.WriteDescriptor(GetID(), m_wallet_descriptor);
+            return dest;
+        };
+        auto dest = get_dest();
+        // Commit even if no destination could be derived, as the top up may have changed the descriptor cache
+        if (!batch.TxnCommit()) throw std::runtime_error(strprintf("Error during descriptors keypool top up. Cannot commit changes for wallet %s", m_storage.GetDisplayName()));
+        return dest;
+    }
+}
+
+util::Result<std::vector<CTxDestination>> DescriptorScriptPubKeyMan::GetNewDestinationsWithDB(WalletBatch& batch, const OutputType type, size_t count)
+{
+    if (!CanGetAddresses()) {
+        return util::Error{_("No addresses available")};
+    }
+    LOCK(cs_desc_man);
+    assert(m_wallet_descriptor.descriptor->IsSingleType()); // This is a combo descriptor which should not be an active descriptor
+    std::optional<OutputType> desc_addr_type = m_wallet_descriptor.descriptor->GetOutputType();
+    assert(desc_addr_type);
+    if (type != *desc_addr_type) {
+        throw std::runtime_error(std::string(__func__) + ": Types are inconsistent. Stored type does not match type of newly generated address");
+    }
+
+    // Top up once for the whole batch, keeping the usual look-ahead past its last address, so
+    // that the new range is derived together rather than one index per address.
+    TopUpWithDB(batch, std::min<size_t>(count + m_keypool_size, std::numeric_limits<int32_t>::max() - m_wallet_descriptor.next_index));
+
+    // Derive the whole batch before advancing next_index, so that a failure part way through
+    // neither hands out nor skips any address.
+    std::vector<CTxDestination> dests;
+    dests.reserve(count);
+    FlatSigningProvider out_keys;
+    std::vector<CScript> scripts_temp;
+    int32_t index{m_wallet_descriptor.next_index};
+    while (dests.size() < count) {
+        scripts_temp.clear();
+        if (!m_wallet_descriptor.descriptor->ExpandFromCache(index, m_wallet_descriptor.cache, scripts_temp, out_keys)) {
             // We can't generate anymore keys
             return util::Error{_("Error: Keypool ran out, please call keypoolrefill first")};
         }
-
         CTxDestination dest;
         if (!ExtractDestination(scripts_temp[0], dest)) {
             return util::Error{_("Error: Cannot extract destination from the generated scriptpubkey")}; // shouldn't happen
         }
-        m_wallet_descriptor.next_index++;
-        WalletBatch(m_storage.GetDatabase()).WriteDescriptor(GetID(), m_wallet_descriptor);
-        return dest;
+        dests.push_back(std::move(dest));
+        ++index;
     }
+
+    const int32_t prev_next_index{m_wallet_descriptor.next_index};
+    m_wallet_descriptor.next_index = index;
+    if (!batch.WriteDescriptor(GetID(), m_wallet_descriptor)) {
+        m_wallet_descriptor.next_index = prev_next_index;
+        throw std::runtime_error(std::string(__func__) + ": writing descriptor failed");
+    }
+    return dests;
 }
 
 isminetype DescriptorScriptPubKeyMan::IsMine(const CScript& script) const
@@ -999,6 +1063,71 @@ bool DescriptorScriptPubKeyMan::TopUp(unsigned int size)
     return res;
 }
 
+//! Maximum number of threads used to derive the scriptPubKeys of a descriptor range when topping up or loading
+static constexpr int MAX_EXPAND_THREADS{8};
+//! Minimum number of indexes derived by each thread, so that short ranges do not start threads
+static constexpr int32_t MIN_EXPAND_INDEXES_PER_THREAD{128};
+//! Maximum number of indexes derived at once, which bounds the memory held by derived indexes
+//! that have not been added yet when topping up or loading a large range
+static constexpr int32_t MAX_EXPAND_BATCH_INDEXES{4096};
+
+namespace {
+//! The result of expanding a descriptor at one index
+struct ExpandedIndex {
+    std::vector<CScript> scripts;
+    FlatSigningProvider out_keys;
+    //! Cache items that could not be derived from the existing cache
+    DescriptorCache cache;
+};
+
+bool ExpandIndex(const Descriptor& desc, int32_t index, const SigningProvider& provider, const DescriptorCache& read_cache, ExpandedIndex& result)
+{
+    // Maybe we have a cached xpub and we can expand from the cache first
+    if (desc.ExpandFromCache(index, read_cache, result.scripts, result.out_keys)) return true;
+    return desc.Expand(index, provider, result.scripts, result.out_keys, &result.cache);
+}
+
+/**
+ * Expand a descriptor at the indexes [start, start + results.size()) with expand(index, result),
+ * splitting long ranges between threads. expand must only read shared state.
+ *
+ * @returns the number of leading indexes that were expanded successfully
+ */
+template <typename ExpandFn>
+size_t ExpandIndexRange(int32_t start, std::span<ExpandedIndex> results, ExpandFn expand)
+{
+    const int32_t count = results.size();
+    const int num_threads{std::clamp(std::min(GetNumCores(), int(count / MIN_EXPAND_INDEXES_PER_THREAD)), 1, MAX_EXPAND_THREADS)};
+    std::vector<char> expanded(count, false);
+    std::vector<std::exception_ptr> errors(num_threads);
+    const auto expand_chunk = [&](int t) {
+        try {
+            for (int32_t i = int64_t{count} * t / num_threads; i < int64_t{count} * (t + 1) / num_threads; ++i) {
+                if (!expand(start + i, results[i])) break;
+                expanded[i] = true;
+            }
+        } catch (...) {
+            errors[t] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            util::ThreadRename(strprintf("descexpand.%i", t));
+            expand_chunk(t);
+        });
+    }
+    expand_chunk(0);
+    for (auto& thread : threads) thread.join();
+
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+    return std::find(expanded.begin(), expanded.end(), false) - expanded.begin();
+}
+} // namespace
+
 bool DescriptorScriptPubKeyMan::TopUpWithDB(WalletBatch& batch, unsigned int size)
 {
     LOCK(cs_desc_man);
@@ -1024,20 +1153,14 @@ bool DescriptorScriptPubKeyMan::TopUpWithDB(WalletBatch& batch, unsigned int siz
     provider.keys = GetKeys();
 
     uint256 id = GetID();
-    for (int32_t i = m_max_cached_index + 1; i < new_range_end; ++i) {
-        FlatSigningProvider out_keys;
-        std::vector<CScript> scripts_temp;
-        DescriptorCache temp_cache;
-        // Maybe we have a cached xpub and we can expand from the cache first
-        if (!m_wallet_descriptor.descriptor->ExpandFromCache(i, m_wallet_descriptor.cache, scripts_temp, out_keys)) {
-            if (!m_wallet_descriptor.descriptor->Expand(i, provider, scripts_temp, out_keys, &temp_cache)) return false;
-        }
+    const auto add_index = [&](const ExpandedIndex& expanded) EXCLUSIVE_LOCKS_REQUIRED(cs_desc_man) {
+        const int32_t i = m_max_cached_index + 1;
         // Add all of the scriptPubKeys to the scriptPubKey set
-        new_spks.insert(scripts_temp.begin(), scripts_temp.end());
-        for (const CScript& script : scripts_temp) {
+        new_spks.insert(expanded.scripts.begin(), expanded.scripts.end());
+        for (const CScript& script : expanded.scripts) {
             m_map_script_pub_keys[script] = i;
         }
-        for (const auto& pk_pair : out_keys.pubkeys) {
+        for (const auto& pk_pair : expanded.out_keys.pubkeys) {
             const CPubKey& pubkey = pk_pair.second;
             if (m_map_pubkeys.count(pubkey) != 0) {
                 // We don't need to give an error here.
@@ -1047,11 +1170,33 @@ bool DescriptorScriptPubKeyMan::TopUpWithDB(WalletBatch& batch, unsigned int siz
             m_map_pubkeys[pubkey] = i;
         }
         // Merge and write the cache
-        DescriptorCache new_items = m_wallet_descriptor.cache.MergeAndDiff(temp_cache);
+        DescriptorCache new_items = m_wallet_descriptor.cache.MergeAndDiff(expanded.cache);
         if (!batch.WriteDescriptorCacheItems(id, new_items)) {
-            throw std::runtime_error(std::string(__func__) + ": writing cache items failed");
+            throw std::runtime_error("TopUpWithDB: writing cache items failed");
         }
         m_max_cached_index++;
+    };
+
+    // Expand the first index on its own. This caches the parent xpubs that the rest of the range
+    // is derived from, and initializes state that descriptors compute lazily (such as musig
+    // aggregate keys) before the descriptor is shared between threads.
+    if (m_max_cached_index + 1 < new_range_end) {
+        ExpandedIndex expanded;
+        if (!ExpandIndex(*m_wallet_descriptor.descriptor, m_max_cached_index + 1, provider, m_wallet_descriptor.cache, expanded)) return false;
+        add_index(expanded);
+    }
+    // Derive the remaining indexes in parallel, one batch at a time, and add each batch in order
+    const Descriptor& desc{*m_wallet_descriptor.descriptor};
+    const DescriptorCache& read_cache{m_wallet_descriptor.cache};
+    while (m_max_cached_index + 1 < new_range_end) {
+        std::vector<ExpandedIndex> expanded(std::min(new_range_end - (m_max_cached_index + 1), MAX_EXPAND_BATCH_INDEXES));
+        const size_t num_expanded{ExpandIndexRange(m_max_cached_index + 1, expanded, [&](int32_t i, ExpandedIndex& result) {
+            return ExpandIndex(desc, i, provider, read_cache, result);
+        })};
+        for (size_t j = 0; j < num_expanded; ++j) {
+            add_index(expanded[j]);
+        }
+        if (num_expanded < expanded.size()) return false;
     }
     m_wallet_descriptor.range_end = new_range_end;
     batch.WriteDescriptor(GetID(), m_wallet_descriptor);
@@ -1237,6 +1382,18 @@ std::unique_ptr<FlatSigningProvider> DescriptorScriptPubKeyMan::GetSigningProvid
 {
     AssertLockHeld(cs_desc_man);
 
+    std::optional<FlatSigningProvider> master_provider;
+    if (HavePrivateKeys() && include_private) {
+        master_provider.emplace();
+        master_provider->keys = GetKeys();
+    }
+    return GetSigningProvider(index, master_provider ? &*master_provider : nullptr);
+}
+
+std::unique_ptr<FlatSigningProvider> DescriptorScriptPubKeyMan::GetSigningProvider(int32_t index, const FlatSigningProvider* master_provider) const
+{
+    AssertLockHeld(cs_desc_man);
+
     std::unique_ptr<FlatSigningProvider> out_keys = std::make_unique<FlatSigningProvider>();
 
     // Fetch SigningProvider from cache to avoid re-deriving
@@ -1252,10 +1409,8 @@ std::unique_ptr<FlatSigningProvider> DescriptorScriptPubKeyMan::GetSigningProvid
         m_map_signing_providers[index] = *out_keys;
     }
 
-    if (HavePrivateKeys() && include_private) {
-        FlatSigningProvider master_provider;
-        master_provider.keys = GetKeys();
-        m_wallet_descriptor.descriptor->ExpandPrivate(index, master_provider, *out_keys);
+    if (master_provider) {
+        m_wallet_descriptor.descriptor->ExpandPrivate(index, *master_provider, *out_keys);
     }
 
     return out_keys;
@@ -1308,6 +1463,20 @@ std::optional<PSBTError> DescriptorScriptPubKeyMan::FillPSBT(PartiallySignedTran
     if (n_signed) {
         *n_signed = 0;
     }
+
+    // Providers for the inputs to sign. Inputs spending scripts at the same index share one, and the
+    // private keys are only fetched (and decrypted) once for the whole PSBT.
+    std::vector<std::unique_ptr<FlatSigningProvider>> input_keys;
+    std::deque<HidingSigningProvider> providers;
+    std::map<int32_t, const SigningProvider*> index_providers;
+    std::optional<FlatSigningProvider> master_provider;
+    std::vector<std::pair<unsigned int, const SigningProvider*>> inputs_to_sign;
+    const auto add_provider = [&](std::unique_ptr<FlatSigningProvider> keys) {
+        providers.emplace_back(keys.get(), /*hide_secret=*/!sign, /*hide_origin=*/!bip32derivs);
+        input_keys.push_back(std::move(keys));
+        return &providers.back();
+    };
+    const bool include_private{sign && HavePrivateKeys()};
     for (unsigned int i = 0; i < psbtx.tx->vin.size(); ++i) {
         const CTxIn& txin = psbtx.tx->vin[i];
         PSBTInput& input = psbtx.inputs.at(i);
@@ -1330,11 +1499,26 @@ std::optional<PSBTError> DescriptorScriptPubKeyMan::FillPSBT(PartiallySignedTran
             continue;
         }
 
-        std::unique_ptr<FlatSigningProvider> keys = std::make_unique<FlatSigningProvider>();
-        std::unique_ptr<FlatSigningProvider> script_keys = GetSigningProvider(script, /*include_private=*/sign);
-        if (script_keys) {
-            keys->Merge(std::move(*script_keys));
-        } else {
+        const SigningProvider* provider{nullptr};
+        {
+            LOCK(cs_desc_man);
+            if (const auto it{m_map_script_pub_keys.find(script)}; it != m_map_script_pub_keys.end()) {
+                const SigningProvider*& index_provider{index_providers[it->second]};
+                if (!index_provider) {
+                    if (include_private && !master_provider) {
+                        master_provider.emplace();
+                        master_provider->keys = GetKeys();
+                    }
+                    if (auto script_keys{GetSigningProvider(it->second, master_provider ? &*master_provider : nullptr)}) {
+                        index_provider = add_provider(std::move(script_keys));
+                    }
+                }
+                provider = index_provider;
+            }
+        }
+        if (!provider) {
+            std::unique_ptr<FlatSigningProvider> keys = std::make_unique<FlatSigningProvider>();
+
             // Maybe there are pubkeys listed that we can sign for
             std::vector<CPubKey> pubkeys;
             pubkeys.reserve(input.hd_keypaths.size() + 2);
@@ -1371,14 +1555,18 @@ std::optional<PSBTError> DescriptorScriptPubKeyMan::FillPSBT(PartiallySignedTran
                     keys->Merge(std::move(*pk_keys));
                 }
             }
+            provider = add_provider(std::move(keys));
         }
+        inputs_to_sign.emplace_back(i, provider);
+    }
 
-        PSBTError res = SignPSBTInput(HidingSigningProvider(keys.get(), /*hide_secret=*/!sign, /*hide_origin=*/!bip32derivs), psbtx, i, &txdata, sighash_type, nullptr, finalize);
-        if (res != PSBTError::OK && res != PSBTError::INCOMPLETE) {
-            return res;
+    const std::vector<PSBTError> results{SignPSBTInputs(inputs_to_sign, psbtx, &txdata, sighash_type, finalize)};
+    for (size_t j = 0; j < inputs_to_sign.size(); ++j) {
+        if (results[j] != PSBTError::OK && results[j] != PSBTError::INCOMPLETE) {
+            return results[j];
         }
 
-        bool signed_one = PSBTInputSigned(input);
+        bool signed_one = PSBTInputSigned(psbtx.inputs.at(inputs_to_sign[j].first));
         if (n_signed && (signed_one || !sign)) {
             // If sign is false, we assume that we _could_ sign if we get here. This
             // will never have false negatives; it is hard to tell under what i
@@ -1428,12 +1616,13 @@ void DescriptorScriptPubKeyMan::SetCache(const DescriptorCache& cache)
     LOCK(cs_desc_man);
     std::set<CScript> new_spks;
     m_wallet_descriptor.cache = cache;
-    for (int32_t i = m_wallet_descriptor.range_start; i < m_wallet_descriptor.range_end; ++i) {
-        FlatSigningProvider out_keys;
-        std::vector<CScript> scripts_temp;
-        if (!m_wallet_descriptor.descriptor->ExpandFromCache(i, m_wallet_descriptor.cache, scripts_temp, out_keys)) {
-            throw std::runtime_error("Error: Unable to expand wallet descriptor from cache");
-        }
+    const Descriptor& desc{*m_wallet_descriptor.descriptor};
+    const auto expand_from_cache = [&desc, &cache](int32_t i, ExpandedIndex& result) {
+        return desc.ExpandFromCache(i, cache, result.scripts, result.out_keys);
+    };
+    const auto add_index = [&](int32_t i, const ExpandedIndex& expanded) EXCLUSIVE_LOCKS_REQUIRED(cs_desc_man) {
+        const std::vector<CScript>& scripts_temp{expanded.scripts};
+        const FlatSigningProvider& out_keys{expanded.out_keys};
         // Add all of the scriptPubKeys to the scriptPubKey set
         new_spks.insert(scripts_temp.begin(), scripts_temp.end());
         for (const CScript& script : scripts_temp) {
@@ -1452,6 +1641,20 @@ void DescriptorScriptPubKeyMan::SetCache(const DescriptorCache& cache)
             m_map_pubkeys[pubkey] = i;
         }
         m_max_cached_index++;
+    };
+
+    // As in TopUpWithDB, expand the first index on its own so that lazily computed descriptor
+    // state is initialized before the rest of the range is expanded in parallel, one batch at
+    // a time.
+    int32_t i = m_wallet_descriptor.range_start;
+    while (i < m_wallet_descriptor.range_end) {
+        std::vector<ExpandedIndex> expanded(i == m_wallet_descriptor.range_start ? 1 : std::min(m_wallet_descriptor.range_end - i, MAX_EXPAND_BATCH_INDEXES));
+        if (ExpandIndexRange(i, expanded, expand_from_cache) < expanded.size()) {
+            throw std::runtime_error("Error: Unable to expand wallet descriptor from cache");
+        }
+        for (const ExpandedIndex& index_expanded : expanded) {
+            add_index(i++, index_expanded);
+        }
     }
     // Make sure the wallet knows about our new spks
     m_storage.TopUpCallback(new_spks, this);
@@ -87,6 +87,8 @@ public:
     explicit ScriptPubKeyMan(WalletStorage& storage) : m_storage(storage) {}
     virtual ~ScriptPubKeyMan() = default;
     virtual util::Result<CTxDestination> GetNewDestination(const OutputType type) { return util::Error{Untranslated("Not supported")}; }
+    //! Get count new destinations at once, writing the changes through the given batch
+    virtual util::Result<std::vector<CTxDestination>> GetNewDestinationsWithDB(WalletBatch& batch, const OutputType type, size_t count) { return util::Error{Untranslated("Not supported")}; }
     virtual isminetype IsMine(const CScript& script) const { return ISMINE_NO; }
 
     //! Check that the given decryption key is valid for this ScriptPubKeyMan, i.e. it decrypts all of the keys handled by it.
@@ -305,6 +307,9 @@ private:
     std::unique_ptr<FlatSigningProvider> GetSigningProvider(const CScript& script, bool include_private = false) const;
     // Fetch the SigningProvider for a given index and optionally include private keys. Called by the above functions.
     std::unique_ptr<FlatSigningProvider> GetSigningProvider(int32_t index, bool include_private = false) const EXCLUSIVE_LOCKS_REQUIRED(cs_desc_man);
+    // Same as above, but derives the private keys from master_provider if it is not null. Lets callers needing many
+    // indexes fetch (and decrypt) the private keys once.
+    std::unique_ptr<FlatSigningProvider> GetSigningProvider(int32_t index, const FlatSigningProvider* master_provider) const EXCLUSIVE_LOCKS_REQUIRED(cs_desc_man);
 
 protected:
     WalletDescriptor m_wallet_descriptor GUARDED_BY(cs_desc_man);
@@ -326,6 +331,7 @@ public:
     mutable RecursiveMutex cs_desc_man;
 
     util::Result<CTxDestination> GetNewDestination(const OutputType type) override;
+    util::Result<std::vector<CTxDestination>> GetNewDestinationsWithDB(WalletBatch& batch, const OutputType type, size_t count) override;
     isminetype IsMine(const CScript& script) const override;
 
     bool CheckDecryptionKey(const CKeyingMaterial& master_key) override;
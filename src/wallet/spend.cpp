@@ -30,6 +30,7 @@
 #include <wallet/wallet.h>
 
 #include <cmath>
+#include <future>
 
 using common::StringForFeeReason;
 using common::TransactionErrorString;
@@ -43,6 +44,8 @@ TRACEPOINT_SEMAPHORE(coin_selection, aps_create_tx_internal);
 
 namespace wallet {
 static constexpr size_t OUTPUT_GROUP_MAX_ENTRIES{100};
+//! Minimum number of output groups for which Knapsack runs concurrently with the other selection algorithms
+static constexpr size_t MIN_GROUPS_FOR_CONCURRENT_SELECTION{1000};
 
 /** Whether the descriptor represents, directly or not, a witness program. */
 static bool IsSegwit(const Descriptor& desc) {
@@ -328,9 +331,9 @@ CoinsResult AvailableCoins(const CWallet& wallet,
     std::set<Txid> trusted_parents;
     // Cache for whether each tx passes the tx level checks (first bool), and whether the transaction is "safe" (second bool)
     std::unordered_map<uint256, std::pair<bool, bool>, SaltedTxidHasher> tx_safe_cache;
-    for (const auto& [outpoint, txo] : wallet.GetTXOs()) {
-        const CWalletTx& wtx = txo.GetWalletTx();
-        const CTxOut& output = txo.GetTxOut();
+    for (const auto& [outpoint, txo] : wallet.GetUnspentTXOs()) {
+        const CWalletTx& wtx = txo->GetWalletTx();
+        const CTxOut& output = txo->GetTxOut();
 
         if (tx_safe_cache.contains(outpoint.hash) && !tx_safe_cache.at(outpoint.hash).first) {
             continue;
@@ -411,9 +414,6 @@ CoinsResult AvailableCoins(const CWallet& wallet,
         if (wallet.IsLockedCoin(outpoint) && params.skip_locked)
             continue;
 
-        if (wallet.IsSpent(outpoint))
-            continue;
-
         isminetype mine = wallet.IsMine(output);
         assert(mine != ISMINE_NO);
 
@@ -712,6 +712,18 @@ util::Result<SelectionResult> ChooseSelectionResult(interfaces::Chain& chain, co
         return util::Error{_("Maximum transaction weight is less than transaction weight without inputs")};
     }
 
+    // Knapsack only uses the mixed group, which none of the other algorithms touch, and it is often
+    // the slowest of them on large pools. When it is certain to run, start it on another thread so
+    // that it overlaps with BnB and CoinGrinder. It still finishes before SRD draws from rng_fast,
+    // so the random choices are the same as when the algorithms run one after another.
+    const int knapsack_max_selection_weight = max_selection_weight - coin_selection_params.change_output_size * WITNESS_SCALE_FACTOR;
+    std::future<util::Result<SelectionResult>> knapsack_future;
+    if (knapsack_max_selection_weight >= 0 && groups.mixed_group.size() >= MIN_GROUPS_FOR_CONCURRENT_SELECTION && GetNumCores() > 1) {
+        knapsack_future = std::async(std::launch::async, [&] {
+            return KnapsackSolver(groups.mixed_group, nTargetValue, coin_selection_params.m_min_change_target, coin_selection_params.rng_fast, knapsack_max_selection_weight);
+        });
+    }
+
     // SFFO frequently causes issues in the context of changeless input sets: skip BnB when SFFO is active
     if (!coin_selection_params.m_subtract_fee_outputs) {
         if (auto bnb_result{SelectCoinsBnB(groups.positive_group, nTargetValue, coin_selection_params.m_cost_of_change, max_selection_weight)}) {
@@ -727,16 +739,28 @@ util::Result<SelectionResult> ChooseSelectionResult(interfaces::Chain& chain, co
     }
 
     // The knapsack solver has some legacy behavior where it will spend dust outputs. We retain this behavior, so don't filter for positive only here.
-    if (auto knapsack_result{KnapsackSolver(groups.mixed_group, nTargetValue, coin_selection_params.m_min_change_target, coin_selection_params.rng_fast, max_selection_weight)}) {
-        results.push_back(*knapsack_result);
-    } else append_error(std::move(knapsack_result));
+    std::optional<util::Result<SelectionResult>> knapsack_result;
+    if (!knapsack_future.valid()) {
+        knapsack_result.emplace(KnapsackSolver(groups.mixed_group, nTargetValue, coin_selection_params.m_min_change_target, coin_selection_params.rng_fast, max_selection_weight));
+    }
 
+    std::optional<util::Result<SelectionResult>> cg_result;
     if (coin_selection_params.m_effective_feerate > CFeeRate{3 * coin_selection_params.m_long_term_feerate}) { // Minimize input set for feerates of at least 3×LTFRE (default: 30 ṩ/vB+)
-        if (auto cg_result{CoinGrinder(groups.positive_group, nTargetValue, coin_selection_params.m_min_change_target, max_selection_weight)}) {
-            cg_result->RecalculateWaste(coin_selection_params.min_viable_change, coin_selection_params.m_cost_of_change, coin_selection_params.m_change_fee);
-            results.push_back(*cg_result);
+        cg_result.emplace(CoinGrinder(groups.positive_group, nTargetValue, coin_selection_params.m_min_change_target, max_selection_weight));
+    }
+    if (knapsack_future.valid()) knapsack_result.emplace(knapsack_future.get());
+
+    // Collect results and errors in the same order as when Knapsack ran before CoinGrinder
+    if (*knapsack_result) {
+        results.push_back(**knapsack_result);
+    } else append_error(std::move(*knapsack_result));
+
+    if (cg_result) {
+        if (*cg_result) {
+            (*cg_result)->RecalculateWaste(coin_selection_params.min_viable_change, coin_selection_params.m_cost_of_change, coin_selection_params.m_change_fee);
+            results.push_back(**cg_result);
         } else {
-            append_error(std::move(cg_result));
+            append_error(std::move(*cg_result));
         }
     }
 
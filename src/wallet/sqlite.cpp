@@ -18,6 +18,7 @@
 
 #include <sqlite3.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
 #include <utility>
@@ -25,6 +26,8 @@
 
 namespace wallet {
 static constexpr int32_t WALLET_SCHEMA_VERSION = 0;
+//! Page cache size in KiB (the default is 2 MiB), large enough to keep the records of big wallets in memory
+static constexpr int WALLET_PAGE_CACHE_KIB{32 * 1024};
 
 static std::span<const std::byte> SpanFromBlob(sqlite3_stmt* stmt, int col)
 {
@@ -146,8 +149,20 @@ SQLiteDatabase::SQLiteDatabase(const fs::path& dir_path, const fs::path& file_pa
     }
 }
 
+//! Maximum number of statement sets kept by SQLiteDatabase for reuse
+static constexpr size_t MAX_CACHED_STATEMENT_SETS{4};
+
 void SQLiteBatch::SetupSQLStatements()
 {
+    SQLiteBatchStatements cached;
+    if (m_database.TakeCachedStatements(cached)) {
+        const auto statements{Statements()};
+        for (size_t i = 0; i < cached.size(); ++i) {
+            *statements[i] = cached[i];
+        }
+        return;
+    }
+
     const std::vector<std::pair<sqlite3_stmt**, const char*>> statements{
         {&m_read_stmt, "SELECT value FROM main WHERE key = ?"},
         {&m_insert_stmt, "INSERT INTO main VALUES(?, ?)"},
@@ -292,6 +307,9 @@ void SQLiteDatabase::Open()
     // Enable fullfsync for the platforms that use it
     SetPragma(m_db, "fullfsync", "true", "Failed to enable fullfsync");
 
+    // A negative cache_size is in KiB rather than in pages
+    SetPragma(m_db, "cache_size", strprintf("%d", -WALLET_PAGE_CACHE_KIB), "Failed to set page cache size");
+
     if (m_use_unsafe_sync) {
         // Use normal synchronous mode for the journal
         LogPrintf("WARNING SQLite is configured to not wait for data to be flushed to disk. Data loss and corruption may occur.\n");
@@ -370,8 +388,36 @@ bool SQLiteDatabase::Backup(const std::string& dest) const
     return res == SQLITE_OK;
 }
 
+bool SQLiteDatabase::TakeCachedStatements(SQLiteBatchStatements& statements)
+{
+    LOCK(m_statements_mutex);
+    if (m_cached_statements.empty()) return false;
+    statements = m_cached_statements.back();
+    m_cached_statements.pop_back();
+    return true;
+}
+
+bool SQLiteDatabase::CacheStatements(const SQLiteBatchStatements& statements)
+{
+    LOCK(m_statements_mutex);
+    if (!m_db || m_cached_statements.size() >= MAX_CACHED_STATEMENT_SETS) return false;
+    m_cached_statements.push_back(statements);
+    return true;
+}
+
 void SQLiteDatabase::Close()
 {
+    // Statements must be finalized before the connection can be closed
+    {
+        LOCK(m_statements_mutex);
+        for (const auto& statements : m_cached_statements) {
+            for (sqlite3_stmt* stmt : statements) {
+                sqlite3_finalize(stmt);
+            }
+        }
+        m_cached_statements.clear();
+    }
+
     int res = sqlite3_close(m_db);
     if (res != SQLITE_OK) {
         throw std::runtime_error(strprintf("SQLiteDatabase: Failed to close database: %s\n", sqlite3_errstr(res)));
@@ -422,6 +468,20 @@ void SQLiteBatch::Close()
         }
     }
 
+    // Keep the prepared statements for the next batch, unless the connection is about to be reset
+    const auto statements_ptrs{Statements()};
+    if (!force_conn_refresh && std::all_of(statements_ptrs.begin(), statements_ptrs.end(), [](sqlite3_stmt** stmt) { return *stmt != nullptr; })) {
+        SQLiteBatchStatements to_cache;
+        for (size_t i = 0; i < to_cache.size(); ++i) {
+            sqlite3_clear_bindings(*statements_ptrs[i]);
+            sqlite3_reset(*statements_ptrs[i]);
+            to_cache[i] = *statements_ptrs[i];
+        }
+        if (m_database.CacheStatements(to_cache)) {
+            for (sqlite3_stmt** stmt : statements_ptrs) *stmt = nullptr;
+        }
+    }
+
     // Free all of the prepared statements
     const std::vector<std::pair<sqlite3_stmt**, const char*>> statements{
         {&m_read_stmt, "read"},
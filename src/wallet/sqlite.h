@@ -8,7 +8,9 @@
 #include <sync.h>
 #include <wallet/db.h>
 
+#include <array>
 #include <semaphore>
+#include <vector>
 
 struct bilingual_str;
 
@@ -18,6 +20,9 @@ struct sqlite3;
 namespace wallet {
 class SQLiteDatabase;
 
+//! Prepared statements of a batch, in the order read, insert, overwrite, delete, delete prefix
+using SQLiteBatchStatements = std::array<sqlite3_stmt*, 5>;
+
 /** RAII class that provides a database cursor */
 class SQLiteCursor : public DatabaseCursor
 {
@@ -72,6 +77,7 @@ private:
      */
     bool m_txn{false};
 
+    std::array<sqlite3_stmt**, 5> Statements() { return {&m_read_stmt, &m_insert_stmt, &m_overwrite_stmt, &m_delete_stmt, &m_delete_prefix_stmt}; }
     void SetupSQLStatements();
     bool ExecStatement(sqlite3_stmt* stmt, std::span<const std::byte> blob);
 
@@ -117,6 +123,14 @@ private:
     static Mutex g_sqlite_mutex;
     static int g_sqlite_count GUARDED_BY(g_sqlite_mutex);
 
+    Mutex m_statements_mutex;
+    /**
+     * Statements of closed batches, kept for new batches so that they do not prepare the same
+     * statements again. Wallets create a batch for most individual writes, which made preparing
+     * statements a large part of the cost of small writes.
+     */
+    std::vector<SQLiteBatchStatements> m_cached_statements GUARDED_BY(m_statements_mutex);
+
     void Cleanup() noexcept EXCLUSIVE_LOCKS_REQUIRED(!g_sqlite_mutex);
 
 public:
@@ -163,6 +177,11 @@ public:
     /** Return true if there is an on-going txn in this connection */
     bool HasActiveTxn();
 
+    /** Take the statements of a closed batch. Returns false if there are none. */
+    bool TakeCachedStatements(SQLiteBatchStatements& statements) EXCLUSIVE_LOCKS_REQUIRED(!m_statements_mutex);
+    /** Keep the statements of a closing batch for reuse. Returns false if they should be finalized instead. */
+    bool CacheStatements(const SQLiteBatchStatements& statements) EXCLUSIVE_LOCKS_REQUIRED(!m_statements_mutex);
+
     sqlite3* m_db{nullptr};
     bool m_use_unsafe_sync;
 };
@@ -1241,6 +1241,60 @@ BOOST_AUTO_TEST_CASE(srd_tests)
     }
 }
 
+BOOST_AUTO_TEST_CASE(knapsack_concurrent_matches_serial)
+{
+    // With at least 1000 groups, ChooseSelectionResult runs Knapsack on another thread
+    // (when there is more than one core). The selection must be the same as running the
+    // algorithms one after another with the same random seed.
+    std::unique_ptr<CWallet> wallet = NewWallet(m_node);
+    FastRandomContext value_rng{/*fDeterministic=*/true};
+    CoinsResult available_coins;
+    for (int i = 0; i < 1200; ++i) {
+        add_coin(available_coins, *wallet, 1000 + value_rng.randrange(10 * COIN), CFeeRate(0), 6 * 24, false, 0, false, /*custom_size=*/68);
+    }
+
+    for (const CAmount target : {3 * COIN, 50 * COIN, 700 * COIN}) {
+        const uint256 seed{value_rng.rand256()};
+        FastRandomContext concurrent_rng{seed};
+        FastRandomContext serial_rng{seed};
+        CoinSelectionParams cs_params{
+            concurrent_rng,
+            /*change_output_size=*/31,
+            /*change_spend_size=*/68,
+            /*min_change_target=*/CENT,
+            /*effective_feerate=*/CFeeRate(0),
+            /*long_term_feerate=*/CFeeRate(0),
+            /*discard_feerate=*/CFeeRate(0),
+            /*tx_noinputs_size=*/10 + 34,
+            /*avoid_partial=*/false,
+        };
+        const CoinEligibilityFilter filter(0, 0, 0);
+        Groups groups = GroupOutputs(*wallet, available_coins, cs_params, {{filter}})[filter].all_groups;
+        BOOST_REQUIRE_GE(groups.mixed_group.size(), 1000U);
+
+        const auto concurrent_result{ChooseSelectionResult(*m_node.chain, target, groups, cs_params)};
+        BOOST_REQUIRE(concurrent_result);
+
+        // The same algorithms in the order the serial path runs them (CoinGrinder is skipped at this feerate)
+        const int max_selection_weight{MAX_STANDARD_TX_WEIGHT - cs_params.tx_noinputs_size * WITNESS_SCALE_FACTOR};
+        const int change_weight{cs_params.change_output_size * WITNESS_SCALE_FACTOR};
+        std::vector<SelectionResult> serial_results;
+        if (auto res{SelectCoinsBnB(groups.positive_group, target, cs_params.m_cost_of_change, max_selection_weight)}) serial_results.push_back(*res);
+        if (auto res{KnapsackSolver(groups.mixed_group, target, cs_params.m_min_change_target, serial_rng, max_selection_weight - change_weight)}) serial_results.push_back(*res);
+        if (auto res{SelectCoinsSRD(groups.positive_group, target, cs_params.m_change_fee, serial_rng, max_selection_weight - change_weight)}) serial_results.push_back(*res);
+        BOOST_REQUIRE(!serial_results.empty());
+        for (auto& result : serial_results) {
+            result.RecalculateWaste(cs_params.min_viable_change, cs_params.m_cost_of_change, cs_params.m_change_fee);
+        }
+        const SelectionResult& serial_result{*std::min_element(serial_results.begin(), serial_results.end())};
+
+        BOOST_CHECK(EqualResult(*concurrent_result, serial_result));
+        BOOST_CHECK(concurrent_result->GetAlgo() == serial_result.GetAlgo());
+        // Both paths drew the same random numbers
+        BOOST_CHECK_EQUAL(concurrent_rng.rand64(), serial_rng.rand64());
+    }
+}
+
 static util::Result<SelectionResult> select_coins(const CAmount& target, const CoinSelectionParams& cs_params, const CCoinControl& cc, std::function<CoinsResult(CWallet&)> coin_setup, const node::NodeContext& m_node)
 {
     std::unique_ptr<CWallet> wallet = NewWallet(m_node);
@@ -5,6 +5,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <test/util/setup_common.h>
+#include <tinyformat.h>
 #include <util/check.h>
 #include <util/fs.h>
 #include <util/translation.h>
@@ -13,6 +14,8 @@
 #include <wallet/test/util.h>
 #include <wallet/walletutil.h>
 
+#include <sqlite3.h>
+
 #include <cstddef>
 #include <fstream>
 #include <memory>
@@ -297,5 +300,119 @@ BOOST_AUTO_TEST_CASE(concurrent_txn_dont_interfere)
     BOOST_CHECK_EQUAL(read_value, value2);
 }
 
+BOOST_AUTO_TEST_CASE(statements_reused_across_batches)
+{
+    DatabaseOptions options;
+    DatabaseStatus status;
+    bilingual_str error;
+    std::unique_ptr<SQLiteDatabase> database = MakeSQLiteDatabase(m_path_root / "sqlite", options, status, error);
+
+    std::string value = "value";
+    std::string read_value;
+
+    // A closed batch leaves its statements for the next one, which must not see stale bindings.
+    {
+        SQLiteBatch batch(*database);
+        BOOST_CHECK(batch.Write(std::string{"key"}, value));
+        BOOST_CHECK(batch.Read(std::string{"key"}, read_value));
+    }
+    {
+        SQLiteBatch batch(*database);
+        BOOST_CHECK(batch.Read(std::string{"key"}, read_value));
+        BOOST_CHECK_EQUAL(read_value, value);
+        BOOST_CHECK(!batch.Exists(std::string{"other_key"}));
+        BOOST_CHECK(batch.Write(std::string{"key2"}, value));
+        BOOST_CHECK(batch.Erase(std::string{"key"}));
+    }
+
+    // Batches that are open at the same time do not share statements, and only a bounded
+    // number of statement sets is kept once they are closed.
+    {
+        std::vector<std::unique_ptr<SQLiteBatch>> batches;
+        for (int i = 0; i < 8; ++i) {
+            batches.push_back(std::make_unique<SQLiteBatch>(*database));
+            BOOST_CHECK(batches.back()->Write(strprintf("key_%d", i), value));
+        }
+        for (int i = 0; i < 8; ++i) {
+            BOOST_CHECK(batches[i]->Read(strprintf("key_%d", 7 - i), read_value));
+        }
+    }
+    int cached_sets{0};
+    SQLiteBatchStatements statements;
+    while (database->TakeCachedStatements(statements)) {
+        ++cached_sets;
+        for (sqlite3_stmt* stmt : statements) sqlite3_finalize(stmt);
+    }
+    BOOST_CHECK(cached_sets > 0 && cached_sets < 8);
+
+    SQLiteBatch batch(*database);
+    BOOST_CHECK(!batch.Exists(std::string{"key"}));
+    BOOST_CHECK(batch.Read(std::string{"key2"}, read_value));
+    BOOST_CHECK_EQUAL(read_value, value);
+}
+
+BOOST_AUTO_TEST_CASE(close_with_cached_statements)
+{
+    DatabaseOptions options;
+    DatabaseStatus status;
+    bilingual_str error;
+    std::unique_ptr<SQLiteDatabase> database = MakeSQLiteDatabase(m_path_root / "sqlite", options, status, error);
+
+    std::string value = "value";
+    std::string read_value;
+    {
+        SQLiteBatch batch(*database);
+        BOOST_CHECK(batch.Write(std::string{"key"}, value));
+    }
+
+    // Closing the connection finalizes the cached statements, otherwise sqlite3_close fails
+    BOOST_CHECK_NO_THROW(database->Close());
+    SQLiteBatchStatements statements;
+    BOOST_CHECK(!database->TakeCachedStatements(statements));
+
+    // Batches of the reopened connection prepare new statements
+    database->Open();
+    SQLiteBatch batch(*database);
+    BOOST_CHECK(batch.Read(std::string{"key"}, read_value));
+    BOOST_CHECK_EQUAL(read_value, value);
+}
+
+BOOST_AUTO_TEST_CASE(statements_after_forced_connection_refresh)
+{
+    DatabaseOptions options;
+    DatabaseStatus status;
+    bilingual_str error;
+    std::unique_ptr<SQLiteDatabase> database = MakeSQLiteDatabase(m_path_root / "sqlite", options, status, error);
+
+    std::string value = "value";
+    std::string read_value;
+    {
+        SQLiteBatch batch(*database);
+        BOOST_CHECK(batch.Write(std::string{"key"}, value));
+    }
+    // Cache a second set, so one is left after the next batch takes one
+    {
+        SQLiteBatch batch1(*database);
+        SQLiteBatch batch2(*database);
+    }
+
+    // A batch that fails to abort its transaction resets the connection when it is closed
+    std::unique_ptr<SQLiteBatch> batch = std::make_unique<SQLiteBatch>(*database);
+    BOOST_CHECK(batch->TxnBegin());
+    BOOST_CHECK(batch->Write(std::string{"key2"}, value));
+    batch->SetExecHandler(std::make_unique<DbExecBlocker>(std::set<std::string>{"ROLLBACK TRANSACTION"}));
+    batch.reset();
+
+    // Statements prepared on the old connection must not be handed out
+    SQLiteBatchStatements statements;
+    BOOST_CHECK(!database->TakeCachedStatements(statements));
+
+    SQLiteBatch batch2(*database);
+    BOOST_CHECK(batch2.Read(std::string{"key"}, read_value));
+    BOOST_CHECK_EQUAL(read_value, value);
+    BOOST_CHECK(!batch2.Exists(std::string{"key2"}));
+    BOOST_CHECK(batch2.Write(std::string{"key3"}, value));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 } // namespace wallet
@@ -80,6 +80,44 @@ BOOST_AUTO_TEST_CASE(psbt_updater_test)
     BOOST_CHECK(m_wallet.FillPSBT(psbtx, complete, std::nullopt, true, true));
 }
 
+BOOST_AUTO_TEST_CASE(psbt_sign_many_inputs)
+{
+    LOCK(m_wallet.cs_wallet);
+    m_wallet.SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+    import_descriptor(m_wallet, "wpkh(xprv9s21ZrQH143K2LE7W4Xf3jATf9jECxSb7wj91ZnmY4qEJrS66Qru9RFqq8xbkgT32ya6HqYJweFdJUEDf5Q6JFV7jMiUws7kQfe6Tv4RbfN/0h/0/*)");
+    import_descriptor(m_wallet, "tr(xprv9s21ZrQH143K2LE7W4Xf3jATf9jECxSb7wj91ZnmY4qEJrS66Qru9RFqq8xbkgT32ya6HqYJweFdJUEDf5Q6JFV7jMiUws7kQfe6Tv4RbfN/0h/1/*)");
+
+    std::vector<CScript> scripts;
+    for (const ScriptPubKeyMan* spk_man : m_wallet.GetAllScriptPubKeyMans()) {
+        for (const CScript& script : spk_man->GetScriptPubKeys()) {
+            scripts.push_back(script);
+        }
+    }
+    BOOST_REQUIRE(!scripts.empty());
+
+    // Spend each script several times, so that inputs share signing providers, with enough inputs
+    // to be signed on several threads.
+    constexpr uint32_t NUM_INPUTS{200};
+    CMutableTransaction tx;
+    for (uint32_t i = 0; i < NUM_INPUTS; ++i) {
+        tx.vin.emplace_back(COutPoint{Txid::FromUint256(uint256::ONE), i});
+    }
+    tx.vout.emplace_back(NUM_INPUTS * 9000, scripts.front());
+    PartiallySignedTransaction psbtx{tx};
+    for (uint32_t i = 0; i < NUM_INPUTS; ++i) {
+        psbtx.inputs[i].witness_utxo = CTxOut{10000, scripts[i % scripts.size()]};
+    }
+
+    bool complete = false;
+    size_t n_signed = 0;
+    BOOST_REQUIRE(!m_wallet.FillPSBT(psbtx, complete, std::nullopt, /*sign=*/true, /*bip32derivs=*/false, &n_signed));
+    BOOST_CHECK(complete);
+    BOOST_CHECK_EQUAL(n_signed, NUM_INPUTS);
+    for (const PSBTInput& input : psbtx.inputs) {
+        BOOST_CHECK(!input.final_script_witness.IsNull());
+    }
+}
+
 BOOST_AUTO_TEST_CASE(parse_hd_keypath)
 {
     std::vector<uint32_t> keypath;
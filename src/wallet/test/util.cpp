@@ -94,6 +94,19 @@ CTxDestination getNewDestination(CWallet& w, OutputType output_type)
     return *Assert(w.GetNewDestination(output_type, ""));
 }
 
+void AddSpentHistory(CWallet& w, const CScript& script, int num_txs)
+{
+    LOCK(w.cs_wallet);
+    CMutableTransaction tx;
+    tx.vin.emplace_back(COutPoint{Txid::FromUint256(uint256::ONE), 0});
+    tx.vout.emplace_back(1 * COIN, script);
+    for (int i = 0; i < num_txs; ++i) {
+        const CTransactionRef ptx{MakeTransactionRef(tx)};
+        Assert(w.AddToWallet(ptx, TxStateConfirmed{w.GetLastBlockHash(), w.GetLastBlockHeight(), i}));
+        tx.vin[0].prevout = COutPoint{ptx->GetHash(), 0};
+    }
+}
+
 MockableCursor::MockableCursor(const MockableData& records, bool pass, std::span<const std::byte> prefix)
 {
     m_pass = pass;
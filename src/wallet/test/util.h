@@ -43,6 +43,11 @@ std::unique_ptr<WalletDatabase> DuplicateMockDatabase(WalletDatabase& database);
 std::string getnewaddress(CWallet& w);
 /** Returns a new destination, of an specific type, from the wallet */
 CTxDestination getNewDestination(CWallet& w, OutputType output_type);
+/**
+ * Adds a history of transactions confirmed in the wallet's last processed block,
+ * each spending the previous one's output to script, so only the last one is unspent.
+ */
+void AddSpentHistory(CWallet& w, const CScript& script, int num_txs);
 
 using MockableData = std::map<SerializeData, SerializeData, std::less<>>;
 
@@ -487,6 +487,66 @@ BOOST_FIXTURE_TEST_CASE(BasicOutputTypesTest, ListCoinsTest)
     }
 }
 
+static void CheckUnspentTXOs(const CWallet& wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
+{
+    size_t unspent{0};
+    for (const auto& [outpoint, txo] : wallet.GetTXOs()) {
+        const auto it{wallet.GetUnspentTXOs().find(outpoint)};
+        if (wallet.IsSpent(outpoint)) {
+            BOOST_CHECK(it == wallet.GetUnspentTXOs().end());
+        } else {
+            BOOST_REQUIRE(it != wallet.GetUnspentTXOs().end());
+            BOOST_CHECK_EQUAL(it->second, &txo);
+            ++unspent;
+        }
+    }
+    BOOST_CHECK_EQUAL(wallet.GetUnspentTXOs().size(), unspent);
+}
+
+BOOST_FIXTURE_TEST_CASE(unspent_txos, ListCoinsTestingSetup)
+{
+    WITH_LOCK(wallet->cs_wallet, CheckUnspentTXOs(*wallet));
+
+    // Spending the mature coinbase to the wallet itself replaces it with the payment and the change.
+    const auto dest{*Assert(wallet->GetNewDestination(OutputType::BECH32, ""))};
+    const CWalletTx& wtx{AddTx(CRecipient{dest, 1 * COIN, /*subtract_fee=*/false})};
+    COutPoint unspent;
+    {
+        LOCK(wallet->cs_wallet);
+        CheckUnspentTXOs(*wallet);
+        for (const CTxIn& txin : wtx.tx->vin) {
+            BOOST_CHECK(!wallet->GetUnspentTXOs().contains(txin.prevout));
+        }
+        BOOST_CHECK(wallet->GetUnspentTXOs().contains(COutPoint{wtx.GetHash(), 0}));
+        BOOST_CHECK(wallet->GetUnspentTXOs().contains(COutPoint{wtx.GetHash(), 1}));
+        unspent = COutPoint{wtx.GetHash(), 0};
+    }
+
+    // An inactive spend of an output removes it, and abandoning the spend adds it back.
+    CMutableTransaction spend;
+    spend.vin.emplace_back(unspent);
+    spend.vout.emplace_back(1 * COIN / 2, GetScriptForDestination(dest));
+    {
+        LOCK(wallet->cs_wallet);
+        BOOST_CHECK(wallet->AddToWallet(MakeTransactionRef(spend), TxStateInactive{}));
+        CheckUnspentTXOs(*wallet);
+        BOOST_CHECK(!wallet->GetUnspentTXOs().contains(unspent));
+        BOOST_CHECK(wallet->GetUnspentTXOs().contains(COutPoint{spend.GetHash(), 0}));
+
+        BOOST_CHECK(wallet->AbandonTransaction(spend.GetHash()));
+        CheckUnspentTXOs(*wallet);
+        BOOST_CHECK(wallet->GetUnspentTXOs().contains(unspent));
+    }
+
+    // The balance only counts the unspent outputs.
+    const Balance balance{GetBalance(*wallet)};
+    CAmount total{0};
+    for (const auto& coin : WITH_LOCK(wallet->cs_wallet, return AvailableCoins(*wallet)).All()) {
+        total += coin.txout.nValue;
+    }
+    BOOST_CHECK_EQUAL(balance.m_mine_trusted, total);
+}
+
 BOOST_FIXTURE_TEST_CASE(wallet_disableprivkeys, TestChain100Setup)
 {
     const std::shared_ptr<CWallet> wallet = std::make_shared<CWallet>(m_node.chain.get(), "", CreateMockableWalletDatabase());
@@ -57,6 +57,7 @@
 #include <util/moneystr.h>
 #include <util/result.h>
 #include <util/string.h>
+#include <util/thread.h>
 #include <util/time.h>
 #include <util/translation.h>
 #include <wallet/coincontrol.h>
@@ -74,6 +75,8 @@
 #include <cassert>
 #include <condition_variable>
 #include <exception>
+#include <map>
+#include <memory>
 #include <optional>
 #include <stdexcept>
 #include <thread>
@@ -308,35 +311,57 @@ class FastWalletRescanFilter
 public:
     FastWalletRescanFilter(const CWallet& wallet) : m_wallet(wallet)
     {
+        auto filter_set{std::make_shared<GCSFilter::ElementSet>()};
         // create initial filter with scripts from all ScriptPubKeyMans
         for (auto spkm : m_wallet.GetAllScriptPubKeyMans()) {
             auto desc_spkm{dynamic_cast<DescriptorScriptPubKeyMan*>(spkm)};
             assert(desc_spkm != nullptr);
-            AddScriptPubKeys(desc_spkm);
+            AddScriptPubKeys(*filter_set, desc_spkm);
             // save each range descriptor's end for possible future filter updates
             if (desc_spkm->IsHDEnabled()) {
                 m_last_range_ends.emplace(desc_spkm->GetID(), desc_spkm->GetEndRange());
             }
         }
+        m_filter_set = std::move(filter_set);
     }
 
-    void UpdateIfNeeded()
+    void UpdateIfNeeded() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
         // repopulate filter with new scripts if top-up has happened since last iteration
+        std::shared_ptr<GCSFilter::ElementSet> filter_set;
         for (const auto& [desc_spkm_id, last_range_end] : m_last_range_ends) {
             auto desc_spkm{dynamic_cast<DescriptorScriptPubKeyMan*>(m_wallet.GetScriptPubKeyMan(desc_spkm_id))};
             assert(desc_spkm != nullptr);
             int32_t current_range_end{desc_spkm->GetEndRange()};
             if (current_range_end > last_range_end) {
-                AddScriptPubKeys(desc_spkm, last_range_end);
+                // The set may be in use by prefetching threads, so it is copied before being extended.
+                if (!filter_set) filter_set = std::make_shared<GCSFilter::ElementSet>(*WITH_LOCK(m_mutex, return m_filter_set));
+                AddScriptPubKeys(*filter_set, desc_spkm, last_range_end);
                 m_last_range_ends.at(desc_spkm->GetID()) = current_range_end;
             }
         }
+        if (filter_set) {
+            LOCK(m_mutex);
+            m_filter_set = std::move(filter_set);
+            ++m_version;
+        }
+    }
+
+    std::optional<bool> MatchesBlock(const uint256& block_hash) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        return MatchesBlock(block_hash, *GetFilterSet().first);
+    }
+
+    std::optional<bool> MatchesBlock(const uint256& block_hash, const GCSFilter::ElementSet& filter_set) const
+    {
+        return m_wallet.chain().blockFilterMatchesAny(BlockFilterType::BASIC, block_hash, filter_set);
     }
 
-    std::optional<bool> MatchesBlock(const uint256& block_hash) const
+    /** The current filter set, and its version, which is increased every time the set is extended. Safe to call from any thread. */
+    std::pair<std::shared_ptr<const GCSFilter::ElementSet>, uint64_t> GetFilterSet() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
     {
-        return m_wallet.chain().blockFilterMatchesAny(BlockFilterType::BASIC, block_hash, m_filter_set);
+        LOCK(m_mutex);
+        return {m_filter_set, m_version};
     }
 
 private:
@@ -348,12 +373,125 @@ private:
       * take possible keypool top-ups into account.
       */
     std::map<uint256, int32_t> m_last_range_ends;
-    GCSFilter::ElementSet m_filter_set;
+    mutable Mutex m_mutex;
+    std::shared_ptr<const GCSFilter::ElementSet> m_filter_set GUARDED_BY(m_mutex);
+    uint64_t m_version GUARDED_BY(m_mutex){0};
 
-    void AddScriptPubKeys(const DescriptorScriptPubKeyMan* desc_spkm, int32_t last_range_end = 0)
+    static void AddScriptPubKeys(GCSFilter::ElementSet& filter_set, const DescriptorScriptPubKeyMan* desc_spkm, int32_t last_range_end = 0)
     {
         for (const auto& script_pub_key : desc_spkm->GetScriptPubKeys(last_range_end)) {
-            m_filter_set.emplace(script_pub_key.begin(), script_pub_key.end());
+            filter_set.emplace(script_pub_key.begin(), script_pub_key.end());
+        }
+    }
+};
+
+//! Maximum number of threads reading blocks ahead of a rescan
+static constexpr int MAX_RESCAN_THREADS{4};
+//! Number of transactions found by a rescan that are written to the database together
+static constexpr size_t RESCAN_TX_WRITE_BATCH_SIZE{1000};
+//! Maximum number of blocks a rescan is read ahead by, which bounds the memory used
+static constexpr int RESCAN_PREFETCH_BLOCKS{16};
+
+/**
+ * Matches blocks of a rescan against the block filters, and reads the ones
+ * that may be relevant, on worker threads ahead of the wallet. The wallet
+ * still processes the blocks one by one in height order with its current
+ * state, since the scripts it looks for change as keys get used.
+ */
+class RescanPrefetcher
+{
+public:
+    struct Block {
+        //! Version of the filter set the block was matched against, see FastWalletRescanFilter::GetFilterSet
+        uint64_t filter_version{0};
+        //! Whether the block filter matched, or nullopt if not checked or not found
+        std::optional<bool> filter_match;
+        //! The block, if it was read
+        std::optional<CBlock> data;
+    };
+
+    RescanPrefetcher(interfaces::Chain& chain, const FastWalletRescanFilter* filter, const uint256& end_hash, int start_height, int end_height, int num_threads)
+        : m_chain(chain), m_filter(filter), m_end_hash(end_hash), m_end_height(end_height), m_next_height(start_height), m_window_end(start_height + RESCAN_PREFETCH_BLOCKS)
+    {
+        for (int i{0}; i < num_threads; ++i) {
+            m_threads.emplace_back(&util::TraceThread, strprintf("rescan.%i", i), [this] { Run(); });
+        }
+    }
+
+    ~RescanPrefetcher()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cv.notify_all();
+        for (auto& thread : m_threads) thread.join();
+    }
+
+    /**
+     * Take the prefetched data of the block at height, if it is block_hash.
+     * Blocks until it is available. Heights must be taken in increasing order.
+     */
+    std::optional<Block> Take(int height, const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        if (height > m_end_height) return std::nullopt;
+        WAIT_LOCK(m_mutex, lock);
+        m_window_end = height + RESCAN_PREFETCH_BLOCKS;
+        m_cv.notify_all();
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_blocks.contains(height); });
+        auto node{m_blocks.extract(height)};
+        if (node.mapped().first != block_hash) return std::nullopt;
+        return std::move(node.mapped().second);
+    }
+
+private:
+    interfaces::Chain& m_chain;
+    const FastWalletRescanFilter* const m_filter;
+    const uint256 m_end_hash;
+    const int m_end_height;
+    std::vector<std::thread> m_threads;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! Height of the next block to be prefetched by a worker
+    int m_next_height GUARDED_BY(m_mutex);
+    //! Blocks are only prefetched below this height
+    int m_window_end GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+    //! Prefetched blocks by height, with their hash
+    std::map<int, std::pair<uint256, Block>> m_blocks GUARDED_BY(m_mutex);
+
+    void Run() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            int height;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_next_height < std::min(m_window_end, m_end_height + 1); });
+                if (m_stop) return;
+                height = m_next_height++;
+            }
+            uint256 block_hash;
+            Block block;
+            try {
+                if (m_chain.findAncestorByHeight(m_end_hash, height, FoundBlock().hash(block_hash))) {
+                    if (m_filter) {
+                        const auto [filter_set, version]{m_filter->GetFilterSet()};
+                        block.filter_version = version;
+                        block.filter_match = m_filter->MatchesBlock(block_hash, *filter_set);
+                    }
+                    if (block.filter_match != false) {
+                        CBlock data;
+                        m_chain.findBlock(block_hash, FoundBlock().data(data));
+                        if (!data.IsNull()) block.data = std::move(data);
+                    }
+                }
+            } catch (const std::exception& e) {
+                // The wallet reads the block itself when it was not prefetched.
+                LogDebug(BCLog::SCAN, "Failed to prefetch block at height %d: %s\n", height, e.what());
+            }
+            {
+                LOCK(m_mutex);
+                m_blocks.emplace(height, std::make_pair(block_hash, std::move(block)));
+            }
+            m_cv.notify_all();
         }
     }
 };
@@ -757,6 +895,7 @@ bool CWallet::IsSpent(const COutPoint& outpoint) const
 void CWallet::AddToSpends(const COutPoint& outpoint, const Txid& txid)
 {
     mapTxSpends.insert(std::make_pair(outpoint, txid));
+    RefreshTXOSpent(outpoint);
 
     UnlockCoin(outpoint);
 
@@ -1022,7 +1161,8 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const TxState& state, const
     bool fUpdated = update_wtx && update_wtx(wtx, fInsertedNew);
     if (fInsertedNew) {
         wtx.nTimeReceived = GetTime();
-        wtx.nOrderPos = IncOrderPosNext(&batch);
+        // A rescan writes the next order position along with its transactions.
+        wtx.nOrderPos = rescanning_old_block ? nOrderPosNext++ : IncOrderPosNext(&batch);
         wtx.m_it_wtxOrdered = wtxOrdered.insert(std::make_pair(wtx.nOrderPos, &wtx));
         wtx.nTimeSmart = ComputeTimeSmart(wtx, rescanning_old_block);
         AddToSpends(wtx);
@@ -1082,15 +1222,25 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const TxState& state, const
     WalletLogPrintf("AddToWallet %s  %s%s %s\n", hash.ToString(), (fInsertedNew ? "new" : ""), (fUpdated ? "update" : ""), TxStateString(state));
 
     // Write to disk
-    if (fInsertedNew || fUpdated)
-        if (!batch.WriteTx(wtx))
+    if (fInsertedNew || fUpdated) {
+        if (rescanning_old_block) {
+            m_rescan_unwritten_txs.insert(hash);
+        } else if (!batch.WriteTx(wtx)) {
             return nullptr;
+        }
+    }
 
     // Break debit/credit balance caches:
     wtx.MarkDirty();
 
     // Cache the outputs that belong to the wallet
     RefreshTXOsFromTx(wtx);
+    // A change of state may make the outputs the transaction spends (un)spent
+    if (!wtx.IsCoinBase()) {
+        for (const CTxIn& txin : wtx.tx->vin) {
+            RefreshTXOSpent(txin.prevout);
+        }
+    }
 
     // Notify UI of new or updated transaction
     NotifyTransactionChanged(hash, fInsertedNew ? CT_NEW : CT_UPDATED);
@@ -1239,6 +1389,7 @@ void CWallet::MarkInputsDirty(const CTransactionRef& tx)
         auto it = mapWallet.find(txin.prevout.hash);
         if (it != mapWallet.end()) {
             it->second.MarkDirty();
+            RefreshTXOSpent(txin.prevout);
         }
     }
 }
@@ -1355,6 +1506,21 @@ void CWallet::RecursiveUpdateTxState(WalletBatch* batch, const Txid& tx_hash, co
     }
 }
 
+bool CWallet::WriteRescannedTxs()
+{
+    AssertLockHeld(cs_wallet);
+    if (m_rescan_unwritten_txs.empty()) return true;
+    const bool written{RunWithinTxn(GetDatabase(), /*process_desc=*/"rescan transaction writes", [&](WalletBatch& batch) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) {
+        for (const Txid& hash : m_rescan_unwritten_txs) {
+            const auto it{mapWallet.find(hash)};
+            if (it != mapWallet.end() && !batch.WriteTx(it->second)) return false;
+        }
+        return batch.WriteOrderPosNext(nOrderPosNext);
+    })};
+    m_rescan_unwritten_txs.clear();
+    return written;
+}
+
 bool CWallet::SyncTransaction(const CTransactionRef& ptx, const SyncTxState& state, bool update_tx, bool rescanning_old_block)
 {
     if (!AddToWalletIfInvolvingMe(ptx, state, update_tx, rescanning_old_block))
@@ -1796,6 +1962,13 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
     double progress_end = chain().guessVerificationProgress(end_hash);
     double progress_current = progress_begin;
     int block_height = start_height;
+    // Match and read the blocks up to the current end of the scan ahead on other threads
+    std::optional<RescanPrefetcher> prefetcher;
+    const int end_height{max_height ? *max_height : WITH_LOCK(cs_wallet, return GetLastBlockHeight())};
+    if (end_height > start_height) {
+        const int num_threads{std::clamp(GetNumCores() - 1, 1, MAX_RESCAN_THREADS)};
+        prefetcher.emplace(chain(), fast_rescan_filter.get(), end_hash, start_height, end_height, num_threads);
+    }
     while (!fAbortRescan && !chain().shutdownRequested()) {
         if (progress_end - progress_begin > 0.0) {
             m_scanning_progress = (progress_current - progress_begin) / (progress_end - progress_begin);
@@ -1812,10 +1985,17 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
             WalletLogPrintf("Still rescanning. At block %d. Progress=%f\n", block_height, progress_current);
         }
 
+        auto prefetched{prefetcher ? prefetcher->Take(block_height, block_hash) : std::nullopt};
         bool fetch_block{true};
         if (fast_rescan_filter) {
             fast_rescan_filter->UpdateIfNeeded();
-            auto matches_block{fast_rescan_filter->MatchesBlock(block_hash)};
+            // The filter set only grows, so a block that matched an older version still matches.
+            std::optional<bool> matches_block;
+            if (prefetched && (prefetched->filter_match == true || prefetched->filter_version == fast_rescan_filter->GetFilterSet().second)) {
+                matches_block = prefetched->filter_match;
+            } else {
+                matches_block = fast_rescan_filter->MatchesBlock(block_hash);
+            }
             if (matches_block.has_value()) {
                 if (*matches_block) {
                     LogDebug(BCLog::SCAN, "Fast rescan: inspect block %d [%s] (filter matched)\n", block_height, block_hash.ToString());
@@ -1839,7 +2019,11 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
         if (fetch_block) {
             // Read block data
             CBlock block;
-            chain().findBlock(block_hash, FoundBlock().data(block));
+            if (prefetched && prefetched->data) {
+                block = std::move(*prefetched->data);
+            } else {
+                chain().findBlock(block_hash, FoundBlock().data(block));
+            }
 
             if (!block.IsNull()) {
                 LOCK(cs_wallet);
@@ -1853,6 +2037,10 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
                 for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
                     SyncTransaction(block.vtx[posInBlock], TxStateConfirmed{block_hash, block_height, static_cast<int>(posInBlock)}, fUpdate, /*rescanning_old_block=*/true);
                 }
+                // The transactions must be on disk before the progress that includes them is.
+                if ((m_rescan_unwritten_txs.size() >= RESCAN_TX_WRITE_BATCH_SIZE || (save_progress && next_interval)) && !WriteRescannedTxs()) {
+                    throw std::runtime_error("DB error adding transaction to wallet, write failed");
+                }
                 // scan succeeded, record block as most recent successfully scanned
                 result.last_scanned_block = block_hash;
                 result.last_scanned_height = block_height;
@@ -1904,6 +2092,9 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
             }
         }
     }
+    if (!WITH_LOCK(cs_wallet, return WriteRescannedTxs())) {
+        throw std::runtime_error("DB error adding transaction to wallet, write failed");
+    }
     if (!max_height) {
         WalletLogPrintf("Scanning current mempool transactions.\n");
         WITH_LOCK(cs_wallet, chain().requestMempoolTransactions(*this));
@@ -2313,17 +2504,24 @@ util::Result<void> CWallet::RemoveTxs(WalletBatch& batch, std::vector<Txid>& txs
     // Register callback to update the memory state only when the db txn is actually dumped to disk
     batch.RegisterTxnListener({.on_commit=[&, erased_txs]() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) {
         // Update the in-memory state and notify upper layers about the removals
+        std::vector<COutPoint> unspent;
         for (const auto& it : erased_txs) {
             const Txid hash{it->first};
             wtxOrdered.erase(it->second.m_it_wtxOrdered);
-            for (const auto& txin : it->second.tx->vin)
+            for (const auto& txin : it->second.tx->vin) {
                 mapTxSpends.erase(txin.prevout);
+                unspent.push_back(txin.prevout);
+            }
             for (unsigned int i = 0; i < it->second.tx->vout.size(); ++i) {
+                m_unspent_txos.erase(COutPoint(Txid::FromUint256(hash), i));
                 m_txos.erase(COutPoint(Txid::FromUint256(hash), i));
             }
             mapWallet.erase(it);
             NotifyTransactionChanged(hash, CT_DELETED);
         }
+        for (const COutPoint& outpoint : unspent) {
+            RefreshTXOSpent(outpoint);
+        }
 
         MarkDirty();
     }, .on_abort={}});
@@ -2369,8 +2567,9 @@ bool CWallet::SetAddressBookWithDB(WalletBatch& batch, const CTxDestination& add
 
 bool CWallet::SetAddressBook(const CTxDestination& address, const std::string& strName, const std::optional<AddressPurpose>& purpose)
 {
-    WalletBatch batch(GetDatabase());
-    return SetAddressBookWithDB(batch, address, strName, purpose);
+    return RunWithinTxn(GetDatabase(), /*process_desc=*/"address book entry update", [&](WalletBatch& batch){
+        return SetAddressBookWithDB(batch, address, strName, purpose);
+    });
 }
 
 bool CWallet::DelAddressBook(const CTxDestination& address)
@@ -2468,6 +2667,31 @@ util::Result<CTxDestination> CWallet::GetNewDestination(const OutputType type, c
     return op_dest;
 }
 
+util::Result<std::vector<CTxDestination>> CWallet::GetNewDestinations(const OutputType type, const std::string& label, size_t count)
+{
+    LOCK(cs_wallet);
+    auto spk_man = GetScriptPubKeyMan(type, /*internal=*/false);
+    if (!spk_man) {
+        return util::Error{strprintf(_("Error: No %s addresses available."), FormatOutputType(type))};
+    }
+
+    WalletBatch batch(GetDatabase());
+    if (!batch.TxnBegin()) return util::Error{strprintf(_("Error: database transaction cannot be executed for wallet %s"), GetDisplayName())};
+    auto op_dests = spk_man->GetNewDestinationsWithDB(batch, type, count);
+    if (op_dests) {
+        for (const CTxDestination& dest : *op_dests) {
+            if (!SetAddressBookWithDB(batch, dest, label, AddressPurpose::RECEIVE)) {
+                batch.TxnAbort();
+                return util::Error{strprintf(_("Error: Cannot write the address book entries of the new addresses for wallet %s"), GetDisplayName())};
+            }
+        }
+    }
+    // When not enough destinations could be derived, no destination was handed out, but the
+    // top up may still have extended the descriptor cache, so commit in both cases.
+    if (!batch.TxnCommit()) throw std::runtime_error(strprintf("Error during address generation. Cannot commit changes for wallet %s", GetDisplayName()));
+    return op_dests;
+}
+
 util::Result<CTxDestination> CWallet::GetNewChangeDestination(const OutputType type)
 {
     LOCK(cs_wallet);
@@ -3869,6 +4093,7 @@ util::Result<void> CWallet::ApplyMigrationData(WalletBatch& local_wallet_batch,
     }
 
     // Update m_txos to match the descriptors remaining in this wallet
+    m_unspent_txos.clear();
     m_txos.clear();
     RefreshAllTXOs();
 
@@ -4423,6 +4648,18 @@ void CWallet::RefreshTXOsFromTx(const CWalletTx& wtx)
         } else {
             m_txos.emplace(outpoint, WalletTXO{wtx, txout, ismine});
         }
+        RefreshTXOSpent(outpoint);
+    }
+}
+
+void CWallet::RefreshTXOSpent(const COutPoint& outpoint)
+{
+    AssertLockHeld(cs_wallet);
+    const auto it{m_txos.find(outpoint)};
+    if (it == m_txos.end() || IsSpent(outpoint)) {
+        m_unspent_txos.erase(outpoint);
+    } else {
+        m_unspent_txos.emplace(outpoint, &it->second);
     }
 }
 
@@ -382,6 +382,16 @@ private:
 
     bool SyncTransaction(const CTransactionRef& tx, const SyncTxState& state, bool update_tx = true, bool rescanning_old_block = false) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
+    /**
+     * Transactions added or updated while rescanning old blocks that have not been written to
+     * the database yet. ScanForWalletTransactions writes them in one database transaction per
+     * group, instead of committing every transaction on its own.
+     */
+    std::set<Txid> m_rescan_unwritten_txs GUARDED_BY(cs_wallet);
+
+    /** Write the transactions of m_rescan_unwritten_txs and the next order position in one database transaction. */
+    bool WriteRescannedTxs() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     /** WalletFlags set on this wallet. */
     std::atomic<uint64_t> m_wallet_flags{0};
 
@@ -440,6 +450,13 @@ private:
 
     //! Set of both spent and unspent transaction outputs owned by this wallet
     std::unordered_map<COutPoint, WalletTXO, SaltedOutpointHasher> m_txos GUARDED_BY(cs_wallet);
+    //! Subset of m_txos that is not spent by any wallet transaction, see IsSpent. Kept up to date as
+    //! transactions are added and change state, so that balances and available coins are computed
+    //! from the unspent outputs only rather than from the whole wallet history.
+    std::unordered_map<COutPoint, const WalletTXO*, SaltedOutpointHasher> m_unspent_txos GUARDED_BY(cs_wallet);
+
+    /** Add or remove an output of m_txos from m_unspent_txos, depending on whether it is spent */
+    void RefreshTXOSpent(const COutPoint& outpoint) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     /**
      * Catch wallet up to current chain, scanning new blocks, updating the best
@@ -527,6 +544,8 @@ public:
 
     const std::unordered_map<COutPoint, WalletTXO, SaltedOutpointHasher>& GetTXOs() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { AssertLockHeld(cs_wallet); return m_txos; };
     std::optional<WalletTXO> GetTXO(const COutPoint& outpoint) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    //! Outputs owned by this wallet that are not spent, see IsSpent
+    const std::unordered_map<COutPoint, const WalletTXO*, SaltedOutpointHasher>& GetUnspentTXOs() const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) { AssertLockHeld(cs_wallet); return m_unspent_txos; };
 
     /** Cache outputs that belong to the wallet from a single transaction */
     void RefreshTXOsFromTx(const CWalletTx& wtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
@@ -789,6 +808,8 @@ public:
     void MarkDestinationsDirty(const std::set<CTxDestination>& destinations) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     util::Result<CTxDestination> GetNewDestination(const OutputType type, const std::string label);
+    //! Get count new destinations at once, adding them to the address book with the given label in the same db txn
+    util::Result<std::vector<CTxDestination>> GetNewDestinations(const OutputType type, const std::string& label, size_t count);
     util::Result<CTxDestination> GetNewChangeDestination(const OutputType type);
 
     isminetype IsMine(const CTxDestination& dest) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+# Copyright (c) The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the address index through the getaddresshistory RPC and the REST interface."""
+
+from decimal import Decimal
+import http.client
+import json
+import urllib.parse
+
+from test_framework.address import (
+    ADDRESS_BCRT1_UNSPENDABLE,
+    address_to_scriptpubkey,
+)
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+)
+from test_framework.wallet import MiniWallet
+
+
+class AddressIndexTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.extra_args = [["-addressindex", "-rest"]]
+
+    def rest_address_history(self, address, query, status=200):
+        url = urllib.parse.urlparse(self.nodes[0].url)
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+        conn.request("GET", f"/rest/addresshistory/{address}.json?{query}")
+        resp = conn.getresponse()
+        assert_equal(resp.status, status)
+        body = resp.read().decode("utf-8")
+        return json.loads(body, parse_float=Decimal) if status == 200 else body
+
+    def test_history(self):
+        node = self.nodes[0]
+        self.log.info("Receiving and spending transactions are listed, oldest first")
+        funding = self.wallet.send_to(from_node=node, scriptPubKey=address_to_scriptpubkey(self.address), amount=10 * 100_000_000)
+        funding_block = self.generate(node, 1)[0]
+        self.recipient.rescan_utxos()
+        spending = self.recipient.send_self_transfer(from_node=node)
+        spending_block = self.generate(node, 1)[0]
+        height = node.getblockcount()
+
+        result = node.getaddresshistory(self.address)
+        assert "next" not in result
+        history = result["history"]
+        assert_equal(history, [
+            {"type": "receive", "amount": Decimal("10"), "blockhash": funding_block, "height": height - 1, "txid": funding["txid"], "vout": 1},
+            {"type": "receive", "amount": spending["tx"].vout[0].nValue / Decimal(100_000_000), "blockhash": spending_block, "height": height, "txid": spending["txid"], "vout": 0},
+            {"type": "spend", "amount": Decimal("10"), "blockhash": spending_block, "height": height, "txid": spending["txid"], "vin": 0},
+        ])
+        assert_equal(self.rest_address_history(self.address, ""), result)
+
+        self.log.info("Results are paged with a cursor")
+        first_page = node.getaddresshistory(self.address, None, 1)
+        assert_equal(first_page["history"], history[0:1])
+        second_page = node.getaddresshistory(self.address, first_page["next"], 1)
+        assert_equal(second_page["history"], history[1:2])
+        assert_equal(node.getaddresshistory(self.address, second_page["next"]), {"history": history[2:]})
+        assert_equal(node.getaddresshistory(self.address, second_page["next"], 1)["history"], history[2:])
+        assert_equal(self.rest_address_history(self.address, f"after={first_page['next']}&count=1"), second_page)
+        return history
+
+    def test_limits(self):
+        node = self.nodes[0]
+        self.log.info("The number of results is capped")
+        assert_equal(len(node.getaddresshistory(self.address, None, 1000)["history"]), 3)
+        assert_raises_rpc_error(-8, "count must be between 1 and 1000", node.getaddresshistory, self.address, None, 1001)
+        assert_raises_rpc_error(-8, "count must be between 1 and 1000", node.getaddresshistory, self.address, None, 0)
+        assert_raises_rpc_error(-8, "Invalid cursor", node.getaddresshistory, self.address, "1:2:3")
+        assert_raises_rpc_error(-8, "Invalid cursor", node.getaddresshistory, self.address, "1:2:2:0")
+        assert_raises_rpc_error(-5, "Invalid address", node.getaddresshistory, "invalid")
+        assert "out of acceptable range" in self.rest_address_history(self.address, "count=1001", status=400)
+        assert "Invalid cursor" in self.rest_address_history(self.address, "after=x", status=400)
+
+    def test_reorg(self, history):
+        node = self.nodes[0]
+        self.log.info("Entries of a disconnected block are listed without a block hash until the index rewinds")
+        spending_block = history[-1]["blockhash"]
+        node.invalidateblock(spending_block)
+        # The index rewinds when the next block is connected, so until then it still has the
+        # entries, but their block is no longer in the active chain.
+        stale_history = node.getaddresshistory(self.address)["history"]
+        assert_equal(stale_history[0], history[0])
+        assert_equal(stale_history[1:], [{k: v for k, v in entry.items() if k != "blockhash"} for entry in history[1:]])
+
+        self.log.info("Entries are listed with the block that confirms them on the new chain")
+        # Pay the coinbase elsewhere, so the new block differs from the invalidated one.
+        new_block = self.generatetoaddress(node, 1, ADDRESS_BCRT1_UNSPENDABLE)[0]
+        assert new_block != spending_block
+        new_history = node.getaddresshistory(self.address)["history"]
+        assert_equal(len(new_history), 3)
+        assert_equal(new_history[0], history[0])
+        for old, new in zip(history[1:], new_history[1:]):
+            assert_equal(new["blockhash"], new_block)
+            assert_equal({**new, "blockhash": spending_block}, old)
+        assert_equal(self.rest_address_history(self.address, ""), {"history": new_history})
+
+    def run_test(self):
+        self.wallet = MiniWallet(self.nodes[0])
+        self.recipient = MiniWallet(self.nodes[0], tag_name="addressindex")
+        self.address = self.recipient.get_address()
+        history = self.test_history()
+        self.test_limits()
+        self.test_reorg(history)
+
+
+if __name__ == '__main__':
+    AddressIndexTest(__file__).main()
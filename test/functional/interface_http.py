@@ -8,6 +8,7 @@ from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import assert_equal, str_to_b64str
 
 import http.client
+import platform
 import time
 import urllib.parse
 
@@ -237,5 +238,29 @@ class HTTPBasicsTest (BitcoinTestFramework):
         conn.request('GET', '/')
         conn.getresponse()
 
+        if platform.system() != "Windows":
+            self.log.info("Check -rpcioloops")
+            self.restart_node(1, extra_args=["-rpcioloops=4"])
+            # The auth cookie changes on restart.
+            urlNode1 = urllib.parse.urlparse(self.nodes[1].url)
+            authpair = f'{urlNode1.username}:{urlNode1.password}'
+            headers = {"Authorization": f"Basic {str_to_b64str(authpair)}"}
+            conns = []
+            for _ in range(8):
+                conn = http.client.HTTPConnection(urlNode1.hostname, urlNode1.port)
+                conn.connect()
+                conns.append(conn)
+            # Keep every connection open across several requests, so they
+            # are spread over the event loops and reused.
+            for _ in range(3):
+                for conn in conns:
+                    conn.request('POST', '/', '{"method": "getbestblockhash"}', headers)
+                    out1 = conn.getresponse().read()
+                    assert b'"error":null' in out1
+            for conn in conns:
+                conn.close()
+            # Shutdown waits for the extra event loops to exit.
+            self.stop_node(1)
+
 if __name__ == '__main__':
     HTTPBasicsTest(__file__).main()
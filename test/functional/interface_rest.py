@@ -412,6 +412,29 @@ class RESTTest (BitcoinTestFramework):
         for tx in txs:
             assert tx in json_obj['tx']
 
+        self.log.info("Test large JSON replies sent in chunks")
+        big_tx = self.wallet.send_self_transfer_multi(from_node=self.nodes[0], num_outputs=1500)
+        big_block_hash = self.generate(self.nodes[0], 1)[0]
+        resp = self.test_rest_request(f"/block/{big_block_hash}", ret_type=RetType.OBJ)
+        assert_equal(resp.getheader("Transfer-Encoding"), "chunked")
+        assert_equal(json.loads(resp.read().decode('utf-8'), parse_float=Decimal), self.nodes[0].getblock(big_block_hash, 3))
+        json_obj = self.test_rest_request(f"/block/notxdetails/{big_block_hash}")
+        assert_equal(json_obj, self.nodes[0].getblock(big_block_hash, 1))
+        # A client going away in the middle of a chunked reply does not affect the node.
+        for _ in range(5):
+            conn = http.client.HTTPConnection(self.url.hostname, self.url.port)
+            conn.request('GET', f"/rest/block/{big_block_hash}.json")
+            conn.getresponse().read(1000)
+            conn.close()
+        assert_equal(self.test_rest_request(f"/block/notxdetails/{big_block_hash}")["hash"], big_block_hash)
+
+        for utxo in big_tx["new_utxos"][:200]:
+            self.wallet.send_self_transfer(from_node=self.nodes[0], utxo_to_spend=utxo)
+        resp = self.test_rest_request("/mempool/contents", ret_type=RetType.OBJ)
+        assert_equal(resp.getheader("Transfer-Encoding"), "chunked")
+        assert_equal(json.loads(resp.read().decode('utf-8'), parse_float=Decimal), self.nodes[0].getrawmempool(verbose=True))
+        self.generate(self.nodes[0], 1)
+
         self.log.info("Test the /chaininfo URI")
 
         bb_hash = self.nodes[0].getbestblockhash()
@@ -7,6 +7,8 @@
 import json
 import os
 from dataclasses import dataclass
+from test_framework.address import ADDRESS_BCRT1_UNSPENDABLE
+from test_framework.authproxy import AuthServiceProxy
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import assert_equal, assert_greater_than_or_equal
 from threading import Thread
@@ -238,11 +240,63 @@ class RPCInterfaceTest(BitcoinTestFramework):
         for t in threads:
             t.join()
 
+    def test_parallel_batch_requests(self):
+        self.log.info("Testing batch requests with -rpcbatchthreads...")
+        self.restart_node(0, ['-rpcbatchthreads=3'])
+        node = self.nodes[0]
+        height = node.getblockcount()
+        hashes = [node.getblockhash(h) for h in range(height + 1)]
+
+        # Read-only calls run concurrently, but the responses stay in order,
+        # and a call that is not read-only is only made after the ones before it.
+        calls = [{"method": "getblockhash", "params": [h]} for h in range(height + 1)]
+        calls.append({"method": "invalidmethod"})
+        calls.append({"method": "getblockcount"})
+        calls.append({"method": "generatetoaddress", "params": [1, ADDRESS_BCRT1_UNSPENDABLE]})
+        calls.append({"method": "getblockcount"})
+        calls.append({"method": "getblockheader", "params": [hashes[0]]})
+        request = [format_request(BatchOptions(version=2), idx, call) for idx, call in enumerate(calls)]
+        rpc_response, http_status = send_json_rpc(node, request)
+        assert_equal(http_status, 200)
+        assert_equal([r["id"] for r in rpc_response], list(range(len(calls))))
+        assert_equal([r["result"] for r in rpc_response[:height + 1]], hashes)
+        assert_equal(rpc_response[height + 1]["error"]["code"], RPC_METHOD_NOT_FOUND)
+        assert_equal(rpc_response[height + 2]["result"], height)
+        assert_equal(rpc_response[height + 4]["result"], height + 1)
+        assert_equal(rpc_response[height + 5]["result"]["height"], 0)
+
+        # Notifications among concurrent calls get no response.
+        request = [format_request(BatchOptions(version=2, notification=idx % 2 == 0), idx, {"method": "getblockcount"}) for idx in range(10)]
+        rpc_response, http_status = send_json_rpc(node, request)
+        assert_equal(http_status, 200)
+        assert_equal([r["id"] for r in rpc_response], [1, 3, 5, 7, 9])
+
+        # Batches sent over different connections at the same time share the
+        # batch threads, and each gets its own responses.
+        height = node.getblockcount()
+        hashes = [node.getblockhash(h) for h in range(height + 1)]
+        request = [format_request(BatchOptions(version=2), h, {"method": "getblockhash", "params": [h]}) for h in range(height + 1)]
+        results = []
+
+        def send_batch():
+            # Each thread needs a connection of its own.
+            results.append(send_json_rpc(AuthServiceProxy(node.url), request))
+        threads = [Thread(target=send_batch) for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        assert_equal(len(results), len(threads))
+        for rpc_response, http_status in results:
+            assert_equal(http_status, 200)
+            assert_equal([r["result"] for r in rpc_response], hashes)
+
     def run_test(self):
         self.test_getrpcinfo()
         self.test_batch_requests()
         self.test_http_status_codes()
         self.test_work_queue_exceeded()
+        self.test_parallel_batch_requests()
 
 
 if __name__ == '__main__':
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# Copyright (c) The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test transaction relay via reconciliation (BIP 330): REQRECON, SKETCH and RECONCILDIFF
+"""
+
+import time
+
+from test_framework.messages import (
+    msg_reconcildiff,
+    msg_reqrecon,
+    msg_sendtxrcncl,
+    msg_sketch,
+    msg_verack,
+    msg_wtxidrelay,
+)
+from test_framework.p2p import P2PInterface
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+from test_framework.wallet import MiniWallet
+
+# Interval between reconciliation requests to outbound peers, see RECON_REQUEST_INTERVAL
+RECON_REQUEST_INTERVAL = 8
+
+
+class ReconciliationPeer(P2PInterface):
+    """An inbound peer that registers for transaction reconciliation during the handshake."""
+    def __init__(self):
+        super().__init__()
+        self.last_sketch = None
+
+    def on_version(self, message):
+        self.send_without_ping(msg_wtxidrelay())
+        sendtxrcncl = msg_sendtxrcncl()
+        sendtxrcncl.version = 1
+        sendtxrcncl.salt = 2
+        self.send_without_ping(sendtxrcncl)
+        self.send_without_ping(msg_verack())
+        self.nServices = message.nServices
+        self.relay = message.relay
+
+    def on_sketch(self, message):
+        self.last_sketch = message
+
+
+class TxReconTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 2
+        self.extra_args = [['-txreconciliation'], ['-txreconciliation']]
+
+    def setup_network(self):
+        self.setup_nodes()
+        # node0 is the initiator for this connection, node1 the responder.
+        self.connect_nodes(0, 1)
+
+    def relay_via_reconciliation(self, sender, receiver):
+        tx = self.wallet.send_self_transfer(from_node=self.nodes[sender])
+
+        # Move time forward until the sender trickled the transaction into its reconciliation
+        # set, a reconciliation round happened, and the receiver requested the transaction.
+        def relayed():
+            self.mocktime += RECON_REQUEST_INTERVAL + 1
+            for node in self.nodes:
+                node.setmocktime(self.mocktime)
+            return tx["txid"] in self.nodes[receiver].getrawmempool()
+        self.wait_until(relayed)
+
+    def test_relay(self):
+        self.log.info('Transactions are relayed through reconciliation rounds in both directions')
+        self.relay_via_reconciliation(sender=1, receiver=0)
+        self.relay_via_reconciliation(sender=0, receiver=1)
+
+        initiator_sent = self.nodes[0].getpeerinfo()[0]["bytessent_per_msg"]
+        responder_sent = self.nodes[1].getpeerinfo()[0]["bytessent_per_msg"]
+        assert "reqrecon" in initiator_sent
+        assert "reconcildiff" in initiator_sent
+        assert "sketch" in responder_sent
+
+    def test_protocol(self):
+        node = self.nodes[0]
+        self.log.info('REQRECON from an inbound peer is answered with a SKETCH')
+        peer = node.add_p2p_connection(ReconciliationPeer())
+        peer.send_and_ping(msg_reqrecon(set_size=0, q=8191))
+        peer.wait_until(lambda: peer.last_sketch is not None)
+        # An empty set difference is estimated to need a capacity of one 32-bit element.
+        assert_equal(len(peer.last_sketch.skdata), 4)
+
+        self.log.info('A second REQRECON before RECONCILDIFF triggers a disconnect')
+        with node.assert_debug_log(["txreconciliation protocol violation (unexpected reqrecon)"]):
+            peer.send_without_ping(msg_reqrecon(set_size=0, q=8191))
+            peer.wait_for_disconnect()
+
+        self.log.info('Unsolicited SKETCH and RECONCILDIFF trigger a disconnect')
+        peer = node.add_p2p_connection(ReconciliationPeer())
+        with node.assert_debug_log(["txreconciliation protocol violation (unexpected or malformed sketch)"]):
+            peer.send_without_ping(msg_sketch(skdata=bytes(4)))
+            peer.wait_for_disconnect()
+        peer = node.add_p2p_connection(ReconciliationPeer())
+        with node.assert_debug_log(["txreconciliation protocol violation (unexpected reconcildiff)"]):
+            peer.send_without_ping(msg_reconcildiff(success=True))
+            peer.wait_for_disconnect()
+
+        self.log.info('Reconciliation messages from peers not registered for reconciliation are ignored')
+        peer = node.add_p2p_connection(P2PInterface())
+        with node.assert_debug_log(["reqrecon from peer=", "ignored, as we do not reconcile transactions with it"]):
+            peer.send_and_ping(msg_reqrecon(set_size=0, q=8191))
+        node.disconnect_p2ps()
+
+    def run_test(self):
+        self.wallet = MiniWallet(self.nodes[0])
+        self.mocktime = int(time.time())
+        for node in self.nodes:
+            node.setmocktime(self.mocktime)
+        self.test_relay()
+        self.test_protocol()
+
+
+if __name__ == '__main__':
+    TxReconTest(__file__).main()
@@ -102,6 +102,11 @@ class KeyPoolTest(BitcoinTestFramework):
         kp_size_after = [wi['keypoolsize_hd_internal'], wi['keypoolsize']]
         assert_equal(kp_size_before, kp_size_after)
 
+        # a batch larger than the locked keypool fails without using up any of its keys
+        assert_raises_rpc_error(-12, "Error: Keypool ran out, please call keypoolrefill first", nodes[0].getnewaddresses, 7, "batch", "bech32")
+        assert_equal(nodes[0].getwalletinfo()['keypoolsize'], kp_size_after[1])
+        assert_raises_rpc_error(-11, "No addresses with label batch", nodes[0].getaddressesbylabel, "batch")
+
         # drain the external keys
         addr = set()
         addr.add(nodes[0].getnewaddress(address_type="bech32"))
@@ -188,5 +193,36 @@ class KeyPoolTest(BitcoinTestFramework):
         res = w2.walletcreatefundedpsbt(inputs=[], outputs=[{destination: 0.00010000}], subtractFeeFromOutputs=[0], feeRate=0.00010, changeAddress=addr.pop())
         assert_equal("psbt" in res, True)
 
+        self.test_getnewaddresses()
+
+    def test_getnewaddresses(self):
+        self.log.info("Test getnewaddresses")
+        node = self.nodes[0]
+        node.createwallet(wallet_name="batch")
+        w = node.get_wallet_rpc("batch")
+
+        # The addresses continue the derivation sequence of getnewaddress, and carry the label
+        first = w.getnewaddress(address_type="bech32")
+        addrs = w.getnewaddresses(5, "deposits", "bech32")
+        last = w.getnewaddress(address_type="bech32")
+        assert_equal(len(set(addrs)), 5)
+        paths = [w.getaddressinfo(a)["hdkeypath"] for a in [first] + addrs + [last]]
+        assert_equal(paths, [f"m/84h/1h/0h/0/{i}" for i in range(7)])
+        assert_equal(sorted(w.getaddressesbylabel("deposits")), sorted(addrs))
+        for addr in addrs:
+            assert_equal(w.getaddressinfo(addr)["ismine"], True)
+
+        # The look-ahead is kept past the last address of a batch larger than the keypool
+        keypoolsize = w.getwalletinfo()["keypoolsize"]
+        addrs = w.getnewaddresses(50, "", "bech32m")
+        assert_equal(len(set(addrs)), 50)
+        assert_equal(w.getaddressinfo(addrs[-1])["hdkeypath"], "m/86h/1h/0h/0/49")
+        assert_equal(w.getwalletinfo()["keypoolsize"], keypoolsize)
+
+        assert_raises_rpc_error(-8, "Invalid count, must be between 1 and 100000", w.getnewaddresses, 0)
+        assert_raises_rpc_error(-8, "Invalid count, must be between 1 and 100000", w.getnewaddresses, 100001)
+        assert_raises_rpc_error(-5, "Unknown address type 'foo'", w.getnewaddresses, 1, "", "foo")
+        assert_raises_rpc_error(-11, "Invalid label name", w.getnewaddresses, 1, "*")
+
 if __name__ == '__main__':
     KeyPoolTest(__file__).main()
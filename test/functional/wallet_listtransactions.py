@@ -92,12 +92,23 @@ class ListTransactionsTest(BitcoinTestFramework):
                             {"category": "receive", "amount": Decimal("0.44")},
                             {"txid": txid})
 
+        self.run_pagination_test()
         self.run_rbf_opt_in_test()
         self.run_externally_generated_address_test()
         self.run_coinjoin_test()
         self.run_invalid_parameters_test()
         self.test_op_return()
 
+    def run_pagination_test(self):
+        self.log.info("Test that pages are slices of the full list, including pages splitting a transaction's entries")
+        node = self.nodes[1]
+        full = node.listtransactions("*", 1000)
+        n = len(full)
+        for count in [1, 2, 3, 5]:
+            for skip in range(n + 2):
+                assert_equal(node.listtransactions("*", count, skip), full[max(0, n - skip - count):max(0, n - skip)])
+        assert_equal(node.listtransactions("*", 0, 0), [])
+
     def run_rbf_opt_in_test(self):
         """Test the opt-in-rbf flag for sent and received transactions."""
 